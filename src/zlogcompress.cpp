@@ -0,0 +1,384 @@
+#include "zlogcompress.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#ifdef ZLOG_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef ZLOG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace zlog {
+
+	bool ZLogCompressor::isSupported(ZLogCompression mode) {
+		switch (mode) {
+		case COMPRESS_NONE:
+			return true;
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP:
+			return true;
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD:
+			return true;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	const char* ZLogCompressor::getSuffix(ZLogCompression mode) {
+		switch (mode) {
+		case COMPRESS_GZIP: return ".gz";
+		case COMPRESS_ZSTD: return ".zst";
+		default:            return "";
+		}
+	}
+
+	int ZLogCompressor::compressFrame(ZLogCompression mode, const char* data, size_t size, std::string& output) {
+		output.clear();
+
+		switch (mode) {
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP: {
+			z_stream stream;
+			std::memset(&stream, 0, sizeof(stream));
+			if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				return -1;
+			}
+
+			output.resize(deflateBound(&stream, static_cast<uLong>(size)) + 32);
+			stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+			stream.avail_in = static_cast<uInt>(size);
+			stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+			stream.avail_out = static_cast<uInt>(output.size());
+
+			int ret = deflate(&stream, Z_FINISH);
+			output.resize(stream.total_out);
+			deflateEnd(&stream);
+			return (ret == Z_STREAM_END) ? 0 : -1;
+		}
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD: {
+			output.resize(ZSTD_compressBound(size));
+			size_t ret = ZSTD_compress(&output[0], output.size(), data, size, ZSTD_CLEVEL_DEFAULT);
+			if (ZSTD_isError(ret)) {
+				output.clear();
+				return -1;
+			}
+			output.resize(ret);
+			return 0;
+		}
+#endif
+		default:
+			(void)data;
+			(void)size;
+			return -1;
+		}
+	}
+
+	int ZLogCompressor::compressFile(ZLogCompression mode, const std::string& srcPath, const std::string& dstPath) {
+		if (mode == COMPRESS_NONE || !isSupported(mode)) {
+			return -1;
+		}
+
+		FILE* src = std::fopen(srcPath.c_str(), "rb");
+		if (src == nullptr) {
+			return -1;
+		}
+
+		FILE* dst = std::fopen(dstPath.c_str(), "wb");
+		if (dst == nullptr) {
+			std::fclose(src);
+			return -1;
+		}
+
+		std::vector<char> in(DEFAULT_COMPRESS_CHUNK_SIZE);
+		std::vector<char> out(DEFAULT_COMPRESS_CHUNK_SIZE);
+		bool failed = false;
+
+#ifdef ZLOG_HAVE_ZLIB
+		if (mode == COMPRESS_GZIP) {
+			z_stream stream;
+			std::memset(&stream, 0, sizeof(stream));
+			failed = (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK);
+
+			int flush = Z_NO_FLUSH;
+			while (!failed && flush != Z_FINISH) {
+				size_t bytes = std::fread(in.data(), 1, in.size(), src);
+				failed = (std::ferror(src) != 0);
+				flush = std::feof(src) ? Z_FINISH : Z_NO_FLUSH;
+
+				stream.next_in = reinterpret_cast<Bytef*>(in.data());
+				stream.avail_in = static_cast<uInt>(bytes);
+				do {
+					stream.next_out = reinterpret_cast<Bytef*>(out.data());
+					stream.avail_out = static_cast<uInt>(out.size());
+					if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+						failed = true;
+						break;
+					}
+					size_t produced = out.size() - stream.avail_out;
+					if (std::fwrite(out.data(), 1, produced, dst) != produced) {
+						failed = true;
+						break;
+					}
+				} while (stream.avail_out == 0);
+			}
+			deflateEnd(&stream);
+		}
+#endif
+
+#ifdef ZLOG_HAVE_ZSTD
+		if (mode == COMPRESS_ZSTD) {
+			ZSTD_CCtx* ctx = ZSTD_createCCtx();
+			failed = (ctx == nullptr);
+
+			bool finished = false;
+			while (!failed && !finished) {
+				size_t bytes = std::fread(in.data(), 1, in.size(), src);
+				failed = (std::ferror(src) != 0);
+				bool last = std::feof(src) != 0;
+				ZSTD_EndDirective directive = last ? ZSTD_e_end : ZSTD_e_continue;
+
+				ZSTD_inBuffer input = { in.data(), bytes, 0 };
+				do {
+					ZSTD_outBuffer output = { out.data(), out.size(), 0 };
+					size_t remaining = ZSTD_compressStream2(ctx, &output, &input, directive);
+					if (ZSTD_isError(remaining) || std::fwrite(out.data(), 1, output.pos, dst) != output.pos) {
+						failed = true;
+						break;
+					}
+					finished = last && remaining == 0;
+				} while (last ? !finished : input.pos < input.size);
+			}
+			ZSTD_freeCCtx(ctx);
+		}
+#endif
+
+		std::fclose(src);
+		if (std::fclose(dst) != 0) {
+			failed = true;
+		}
+
+		if (failed) {
+			std::remove(dstPath.c_str());
+			return -1;
+		}
+
+		std::remove(srcPath.c_str());
+		return 0;
+	}
+
+	ZLogCompressStream::ZLogCompressStream()
+		: mode_(COMPRESS_NONE)
+		, context_(nullptr)
+		, frameOpen_(false)
+		, frameInput_(0)
+		, frameStart_(std::chrono::steady_clock::now()) {
+	}
+
+	ZLogCompressStream::~ZLogCompressStream() {
+		release();
+	}
+
+	int ZLogCompressStream::write(ZLogCompression mode, const char* data, size_t size, std::string& output) {
+		output.clear();
+
+		if (mode != mode_ || context_ == nullptr) {
+			release();
+			if (create(mode) != 0) {
+				return -1;
+			}
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (!frameOpen_) {
+			frameOpen_ = true;
+			frameInput_ = 0;
+			frameStart_ = now;
+		}
+		frameInput_ += size;
+
+		bool end = frameInput_ >= DEFAULT_COMPRESS_FRAME_SIZE ||
+			now - frameStart_ >= std::chrono::milliseconds(DEFAULT_COMPRESS_FRAME_MS);
+		return compress(data, size, end, output);
+	}
+
+	int ZLogCompressStream::finish(std::string& output) {
+		output.clear();
+		if (!frameOpen_ || context_ == nullptr) {
+			return 0;
+		}
+		return compress(nullptr, 0, true, output);
+	}
+
+	void ZLogCompressStream::reset() {
+		if (context_ == nullptr || !frameOpen_) {
+			frameOpen_ = false;
+			return;
+		}
+
+		switch (mode_) {
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP:
+			deflateReset(static_cast<z_stream*>(context_));
+			break;
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD:
+			ZSTD_CCtx_reset(static_cast<ZSTD_CCtx*>(context_), ZSTD_reset_session_only);
+			break;
+#endif
+		default:
+			break;
+		}
+		frameOpen_ = false;
+	}
+
+	bool ZLogCompressStream::isFrameOpen() const {
+		return frameOpen_;
+	}
+
+	int ZLogCompressStream::create(ZLogCompression mode) {
+		switch (mode) {
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP: {
+			z_stream* stream = new z_stream;
+			std::memset(stream, 0, sizeof(*stream));
+			if (deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				delete stream;
+				return -1;
+			}
+			context_ = stream;
+			break;
+		}
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD: {
+			ZSTD_CCtx* ctx = ZSTD_createCCtx();
+			if (ctx == nullptr) {
+				return -1;
+			}
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+			context_ = ctx;
+			break;
+		}
+#endif
+		default:
+			return -1;
+		}
+
+		mode_ = mode;
+		frameOpen_ = false;
+		return 0;
+	}
+
+	int ZLogCompressStream::compress(const char* data, size_t size, bool end, std::string& output) {
+		switch (mode_) {
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP: {
+			z_stream* stream = static_cast<z_stream*>(context_);
+			stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+			stream->avail_in = static_cast<uInt>(size);
+
+			int flush = end ? Z_FINISH : Z_SYNC_FLUSH;
+			while (true) {
+				size_t offset = output.size();
+				size_t chunk = std::max<size_t>(size + size / 8 + 64, 4096);
+				output.resize(offset + chunk);
+				stream->next_out = reinterpret_cast<Bytef*>(&output[offset]);
+				stream->avail_out = static_cast<uInt>(chunk);
+
+				int ret = deflate(stream, flush);
+				output.resize(offset + (chunk - stream->avail_out));
+				if (ret == Z_STREAM_ERROR || (ret == Z_BUF_ERROR && stream->avail_out == chunk)) {
+					output.clear();
+					deflateReset(stream);
+					frameOpen_ = false;
+					return -1;
+				}
+				if (end ? (ret == Z_STREAM_END) : (stream->avail_out != 0)) {
+					break;
+				}
+			}
+
+			if (end) {
+				deflateReset(stream);
+				frameOpen_ = false;
+			}
+			return 0;
+		}
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD: {
+			ZSTD_CCtx* ctx = static_cast<ZSTD_CCtx*>(context_);
+			ZSTD_inBuffer input = { data, size, 0 };
+			ZSTD_EndDirective directive = end ? ZSTD_e_end : ZSTD_e_flush;
+
+			size_t remaining = 0;
+			do {
+				size_t offset = output.size();
+				size_t chunk = ZSTD_CStreamOutSize();
+				output.resize(offset + chunk);
+				ZSTD_outBuffer out = { &output[offset], chunk, 0 };
+				remaining = ZSTD_compressStream2(ctx, &out, &input, directive);
+				if (ZSTD_isError(remaining)) {
+					output.clear();
+					ZSTD_CCtx_reset(ctx, ZSTD_reset_session_only);
+					frameOpen_ = false;
+					return -1;
+				}
+				output.resize(offset + out.pos);
+			} while (remaining != 0);
+
+			if (end) {
+				frameOpen_ = false;
+			}
+			return 0;
+		}
+#endif
+		default:
+			(void)data;
+			(void)size;
+			(void)end;
+			(void)output;
+			return -1;
+		}
+	}
+
+	void ZLogCompressStream::release() {
+		if (context_ == nullptr) {
+			return;
+		}
+
+		switch (mode_) {
+#ifdef ZLOG_HAVE_ZLIB
+		case COMPRESS_GZIP: {
+			z_stream* stream = static_cast<z_stream*>(context_);
+			deflateEnd(stream);
+			delete stream;
+			break;
+		}
+#endif
+#ifdef ZLOG_HAVE_ZSTD
+		case COMPRESS_ZSTD:
+			ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(context_));
+			break;
+#endif
+		default:
+			break;
+		}
+
+		context_ = nullptr;
+		mode_ = COMPRESS_NONE;
+		frameOpen_ = false;
+	}
+
+} // namespace zlog
@@ -0,0 +1,57 @@
+#ifndef __ZLOG_COMPRESS__
+#define __ZLOG_COMPRESS__
+
+#include <string>
+#include <chrono>
+#include <cstddef>
+
+namespace zlog {
+
+	static const size_t DEFAULT_COMPRESS_CHUNK_SIZE = 256 * 1024;
+	static const size_t DEFAULT_COMPRESS_FRAME_SIZE = 4 * 1024 * 1024;
+	static const int    DEFAULT_COMPRESS_FRAME_MS   = 60 * 1000;
+
+	enum ZLogCompression {
+		COMPRESS_NONE,
+		COMPRESS_GZIP,
+		COMPRESS_ZSTD
+	};
+
+	class ZLogCompressor {
+	public:
+		static bool isSupported(ZLogCompression mode);
+		static const char* getSuffix(ZLogCompression mode);
+		static int compressFrame(ZLogCompression mode, const char* data, size_t size, std::string& output);
+		static int compressFile(ZLogCompression mode, const std::string& srcPath, const std::string& dstPath);
+	};
+
+	class ZLogCompressStream {
+	public:
+		ZLogCompressStream();
+		~ZLogCompressStream();
+
+		ZLogCompressStream(const ZLogCompressStream&) = delete;
+		ZLogCompressStream& operator=(const ZLogCompressStream&) = delete;
+
+		int write(ZLogCompression mode, const char* data, size_t size, std::string& output);
+		int finish(std::string& output);
+		void reset();
+
+		bool isFrameOpen() const;
+
+	private:
+		int create(ZLogCompression mode);
+		int compress(const char* data, size_t size, bool end, std::string& output);
+		void release();
+
+	private:
+		ZLogCompression mode_;
+		void* context_;
+		bool frameOpen_;
+		size_t frameInput_;
+		std::chrono::steady_clock::time_point frameStart_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_COMPRESS__
@@ -0,0 +1,326 @@
+#include "zlogcrash.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <thread>
+#else
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace zlog {
+
+	namespace {
+
+		const int kCrashSignals[] = {
+			SIGSEGV,
+			SIGFPE,
+			SIGILL,
+			SIGABRT,
+#ifndef _WIN32
+			SIGBUS,
+#endif
+		};
+
+		const size_t kCrashSignalCount = sizeof(kCrashSignals) / sizeof(kCrashSignals[0]);
+
+		ZLogCrashCallback g_callback = nullptr;
+		std::terminate_handler g_previousTerminate = nullptr;
+
+#ifdef _WIN32
+		void (*g_previousHandlers[kCrashSignalCount])(int);
+#else
+		struct sigaction g_previousActions[kCrashSignalCount];
+		char g_altStack[64 * 1024];
+#endif
+
+		void resetSignal(int signal) {
+#ifdef _WIN32
+			std::signal(signal, SIG_DFL);
+#else
+			struct sigaction action;
+			std::memset(&action, 0, sizeof(action));
+			action.sa_handler = SIG_DFL;
+			sigemptyset(&action.sa_mask);
+			sigaction(signal, &action, nullptr);
+#endif
+		}
+
+	} // namespace
+
+	int ZLogCrashHandler::install(ZLogCrashCallback callback) {
+		if (callback == nullptr) {
+			return -1;
+		}
+
+		bool installed = isInstalled();
+		g_callback = callback;
+		if (installed) {
+			return 0;
+		}
+
+#ifdef _WIN32
+		for (size_t i = 0; i < kCrashSignalCount; ++i) {
+			g_previousHandlers[i] = std::signal(kCrashSignals[i], handleSignal);
+		}
+#else
+		stack_t stack;
+		std::memset(&stack, 0, sizeof(stack));
+		stack.ss_sp = g_altStack;
+		stack.ss_size = sizeof(g_altStack);
+		sigaltstack(&stack, nullptr);
+
+		struct sigaction action;
+		std::memset(&action, 0, sizeof(action));
+		action.sa_handler = handleSignal;
+		action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+		sigemptyset(&action.sa_mask);
+		for (size_t i = 0; i < kCrashSignalCount; ++i) {
+			sigaction(kCrashSignals[i], &action, &g_previousActions[i]);
+		}
+#endif
+
+		g_previousTerminate = std::set_terminate(handleTerminate);
+		return 0;
+	}
+
+	void ZLogCrashHandler::uninstall() {
+		if (!isInstalled()) {
+			return;
+		}
+
+		for (size_t i = 0; i < kCrashSignalCount; ++i) {
+#ifdef _WIN32
+			std::signal(kCrashSignals[i], g_previousHandlers[i]);
+#else
+			sigaction(kCrashSignals[i], &g_previousActions[i], nullptr);
+#endif
+		}
+
+		std::set_terminate(g_previousTerminate);
+		g_previousTerminate = nullptr;
+		g_callback = nullptr;
+	}
+
+	bool ZLogCrashHandler::isInstalled() {
+		return g_callback != nullptr;
+	}
+
+	void ZLogCrashHandler::armWatchdog(int deadlineMs) {
+#ifdef _WIN32
+		(void)deadlineMs;
+#else
+		if (deadlineMs <= 0) {
+			return;
+		}
+		resetSignal(SIGALRM);
+		alarm(static_cast<unsigned int>((deadlineMs + 999) / 1000 + 1));
+#endif
+	}
+
+	int64_t ZLogCrashHandler::monotonicMs() {
+#ifdef _WIN32
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+	}
+
+	void ZLogCrashHandler::sleepMs(int ms) {
+#ifdef _WIN32
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#else
+		struct timespec ts;
+		ts.tv_sec = ms / 1000;
+		ts.tv_nsec = static_cast<long>(ms % 1000) * 1000000;
+		nanosleep(&ts, nullptr);
+#endif
+	}
+
+	void ZLogCrashHandler::reraise(int signal) {
+		resetSignal(signal);
+		std::raise(signal);
+	}
+
+	const char* ZLogCrashHandler::getSignalName(int signal) {
+		switch (signal) {
+		case SIGSEGV: return "SIGSEGV";
+		case SIGFPE:  return "SIGFPE";
+		case SIGILL:  return "SIGILL";
+		case SIGABRT: return "SIGABRT";
+#ifndef _WIN32
+		case SIGBUS:  return "SIGBUS";
+#endif
+		default:      return "UNKNOWN";
+		}
+	}
+
+	int ZLogCrashHandler::openAppend(const char* path) {
+#ifdef _WIN32
+		return _open(path, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+		return ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+	}
+
+	int ZLogCrashHandler::writeAll(int fd, const char* data, size_t size) {
+		while (size > 0) {
+#ifdef _WIN32
+			int ret = _write(fd, data, static_cast<unsigned int>(size));
+#else
+			ssize_t ret = ::write(fd, data, size);
+#endif
+			if (ret < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return -1;
+			}
+			data += ret;
+			size -= static_cast<size_t>(ret);
+		}
+		return 0;
+	}
+
+	void ZLogCrashHandler::syncAndClose(int fd) {
+		if (fd < 0) {
+			return;
+		}
+#ifdef _WIN32
+		_commit(fd);
+		_close(fd);
+#else
+		::fsync(fd);
+		::close(fd);
+#endif
+	}
+
+	void ZLogCrashHandler::handleSignal(int signal) {
+		ZLogCrashCallback callback = g_callback;
+		if (callback != nullptr) {
+			callback(signal);
+		}
+		reraise(signal);
+	}
+
+	void ZLogCrashHandler::handleTerminate() {
+		ZLogCrashCallback callback = g_callback;
+		if (callback != nullptr) {
+			callback(SIGABRT);
+		}
+
+		resetSignal(SIGABRT);
+		if (g_previousTerminate != nullptr) {
+			g_previousTerminate();
+		}
+		std::abort();
+	}
+
+	ZLogCrashLine::ZLogCrashLine()
+		: size_(0) {
+	}
+
+	void ZLogCrashLine::clear() {
+		size_ = 0;
+	}
+
+	void ZLogCrashLine::append(const char* data, size_t size) {
+		size_t room = sizeof(data_) - 1 - size_;
+		if (size > room) {
+			size = room;
+		}
+		std::memcpy(data_ + size_, data, size);
+		size_ += size;
+	}
+
+	void ZLogCrashLine::append(const char* str) {
+		append(str, std::strlen(str));
+	}
+
+	void ZLogCrashLine::appendNumber(uint64_t value, int width) {
+		char digits[24];
+		int count = 0;
+		do {
+			digits[count++] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		} while (value > 0 && count < static_cast<int>(sizeof(digits)));
+
+		while (count < width && count < static_cast<int>(sizeof(digits))) {
+			digits[count++] = '0';
+		}
+
+		char out[24];
+		for (int i = 0; i < count; ++i) {
+			out[i] = digits[count - 1 - i];
+		}
+		append(out, static_cast<size_t>(count));
+	}
+
+	void ZLogCrashLine::appendTimestamp(int64_t epochMs, long utcOffsetSeconds) {
+		int64_t localMs = epochMs + static_cast<int64_t>(utcOffsetSeconds) * 1000;
+		int64_t seconds = localMs / 1000;
+		int64_t millis = localMs % 1000;
+		if (millis < 0) {
+			millis += 1000;
+			seconds -= 1;
+		}
+
+		int64_t days = seconds / 86400;
+		int64_t daySeconds = seconds % 86400;
+		if (daySeconds < 0) {
+			daySeconds += 86400;
+			days -= 1;
+		}
+
+		days += 719468;
+		int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+		int64_t dayOfEra = days - era * 146097;
+		int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+		int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+		int64_t mp = (5 * dayOfYear + 2) / 153;
+		int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+		int64_t month = mp < 10 ? mp + 3 : mp - 9;
+		int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+		appendNumber(static_cast<uint64_t>(year), 4);
+		append("-", 1);
+		appendNumber(static_cast<uint64_t>(month), 2);
+		append("-", 1);
+		appendNumber(static_cast<uint64_t>(day), 2);
+		append(" ", 1);
+		appendNumber(static_cast<uint64_t>(daySeconds / 3600), 2);
+		append(":", 1);
+		appendNumber(static_cast<uint64_t>(daySeconds / 60 % 60), 2);
+		append(":", 1);
+		appendNumber(static_cast<uint64_t>(daySeconds % 60), 2);
+		append(".", 1);
+		appendNumber(static_cast<uint64_t>(millis), 3);
+	}
+
+	void ZLogCrashLine::endLine() {
+		data_[size_++] = '\n';
+	}
+
+	const char* ZLogCrashLine::data() const {
+		return data_;
+	}
+
+	size_t ZLogCrashLine::size() const {
+		return size_;
+	}
+
+} // namespace zlog
@@ -0,0 +1,57 @@
+#ifndef __ZLOG_CRASH__
+#define __ZLOG_CRASH__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const int    DEFAULT_CRASH_DEADLINE_MS = 2000;
+	static const size_t ZLOG_CRASH_LINE_SIZE      = 8192;
+	static const size_t MAX_CRASH_LOGGERS         = 16;
+
+	typedef void (*ZLogCrashCallback)(int signal);
+
+	class ZLogCrashHandler {
+	public:
+		static int install(ZLogCrashCallback callback);
+		static void uninstall();
+		static bool isInstalled();
+
+		static void armWatchdog(int deadlineMs);
+		static int64_t monotonicMs();
+		static void sleepMs(int ms);
+		static void reraise(int signal);
+		static const char* getSignalName(int signal);
+
+		static int openAppend(const char* path);
+		static int writeAll(int fd, const char* data, size_t size);
+		static void syncAndClose(int fd);
+
+	private:
+		static void handleSignal(int signal);
+		static void handleTerminate();
+	};
+
+	class ZLogCrashLine {
+	public:
+		ZLogCrashLine();
+
+		void clear();
+		void append(const char* data, size_t size);
+		void append(const char* str);
+		void appendNumber(uint64_t value, int width = 0);
+		void appendTimestamp(int64_t epochMs, long utcOffsetSeconds);
+		void endLine();
+
+		const char* data() const;
+		size_t size() const;
+
+	private:
+		char data_[ZLOG_CRASH_LINE_SIZE];
+		size_t size_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_CRASH__
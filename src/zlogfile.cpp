@@ -0,0 +1,545 @@
+#include "zlogfile.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <malloc.h>
+#define ZLOG_OPEN(path) _open(path, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | _O_NOINHERIT, _S_IREAD | _S_IWRITE)
+#define ZLOG_WRITE(fd, data, size) _write(fd, data, static_cast<unsigned int>(size))
+#define ZLOG_CLOSE(fd) _close(fd)
+#define ZLOG_DATASYNC(fd) _commit(fd)
+#define ZLOG_FSTAT(fd, st) _fstat64(fd, st)
+#define ZLOG_STAT_STRUCT struct _stat64
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#define ZLOG_OPEN(path) ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)
+#define ZLOG_WRITE(fd, data, size) ::write(fd, data, size)
+#define ZLOG_CLOSE(fd) ::close(fd)
+#if defined(__APPLE__)
+#define ZLOG_DATASYNC(fd) ::fsync(fd)
+#else
+#define ZLOG_DATASYNC(fd) ::fdatasync(fd)
+#endif
+#define ZLOG_FSTAT(fd, st) ::fstat(fd, st)
+#define ZLOG_STAT_STRUCT struct stat
+#endif
+
+namespace zlog {
+
+	ZLogFileWriter::ZLogFileWriter()
+		: fd_(-1)
+		, buffer_(nullptr)
+		, bufferSize_(0)
+		, bufferUsed_(0)
+		, fileOffset_(0)
+		, allocatedEnd_(0)
+		, preallocateSize_(0)
+		, lastSizeRefresh_(std::chrono::steady_clock::now())
+		, unsyncedMode_(0)
+		, compression_(COMPRESS_NONE)
+		, lastError_(0)
+		, reportedError_(0) {
+	}
+
+	ZLogFileWriter::~ZLogFileWriter() {
+		close();
+		releaseBuffer();
+	}
+
+	int ZLogFileWriter::open(const std::string& path, size_t bufferSize) {
+		close();
+
+		int fd;
+		do {
+			fd = ZLOG_OPEN(path.c_str());
+		} while (fd < 0 && errno == EINTR);
+
+		if (fd < 0) {
+			lastError_ = errno;
+			return -1;
+		}
+
+		if (allocateBuffer(bufferSize) != 0) {
+			ZLOG_CLOSE(fd);
+			return -1;
+		}
+
+		ZLOG_STAT_STRUCT st;
+		if (ZLOG_FSTAT(fd, &st) != 0) {
+			lastError_ = errno;
+			ZLOG_CLOSE(fd);
+			return -1;
+		}
+
+		fd_ = fd;
+		path_ = path;
+		compressStream_.reset();
+		bufferUsed_ = 0;
+		fileOffset_ = static_cast<size_t>(st.st_size);
+		allocatedEnd_ = fileOffset_;
+		lastSizeRefresh_ = std::chrono::steady_clock::now();
+		unsyncedMode_ = 0;
+		lastError_ = 0;
+		reportedError_ = 0;
+		return 0;
+	}
+
+	int ZLogFileWriter::write(const char* data, size_t size) {
+		if (fd_ < 0) {
+			lastError_ = EBADF;
+			return -1;
+		}
+
+		if (bufferUsed_ + size > bufferSize_) {
+			if (flush() != 0) {
+				return -1;
+			}
+		}
+
+		if (size >= bufferSize_) {
+			return writeFrame(data, size);
+		}
+
+		std::memcpy(buffer_ + bufferUsed_, data, size);
+		bufferUsed_ += size;
+		return 0;
+	}
+
+	int ZLogFileWriter::writeDirect(const char* data, size_t size) {
+		if (fd_ < 0 || compression_ != COMPRESS_NONE) {
+			return -1;
+		}
+
+		if (bufferUsed_ > 0) {
+			size_t used = bufferUsed_;
+			bufferUsed_ = 0;
+			if (writeAll(buffer_, used) != 0) {
+				return -1;
+			}
+		}
+		return writeAll(data, size);
+	}
+
+	int ZLogFileWriter::flush() {
+		if (fd_ < 0 || bufferUsed_ == 0) {
+			return 0;
+		}
+
+		int ret = writeFrame(buffer_, bufferUsed_);
+		bufferUsed_ = 0;
+		return ret;
+	}
+
+	int ZLogFileWriter::sync() {
+		if (fd_ < 0) {
+			return 0;
+		}
+
+		int ret = flush();
+		if (ZLOG_DATASYNC(fd_) != 0 && ret == 0) {
+			lastError_ = errno;
+			ret = -1;
+		}
+		unsyncedMode_ = 0;
+		return ret;
+	}
+
+	int ZLogFileWriter::close() {
+		if (fd_ < 0) {
+			return 0;
+		}
+
+		int ret = finishFrame();
+		if (unsyncedMode_ != 0 && sync() != 0 && ret == 0) {
+			ret = -1;
+		}
+		releasePreallocation();
+		if (ZLOG_CLOSE(fd_) != 0 && ret == 0) {
+			lastError_ = errno;
+			ret = -1;
+		}
+		fd_ = -1;
+		return ret;
+	}
+
+	int ZLogFileWriter::setBufferSize(size_t size) {
+		if (size == bufferSize_) {
+			return 0;
+		}
+
+		if (flush() != 0) {
+			return -1;
+		}
+		return allocateBuffer(size);
+	}
+
+	int ZLogFileWriter::setPreallocateSize(size_t size) {
+		preallocateSize_ = size;
+		return 0;
+	}
+
+	int ZLogFileWriter::setCompression(ZLogCompression mode) {
+		if (!ZLogCompressor::isSupported(mode)) {
+			return -1;
+		}
+
+		if (mode == compression_) {
+			return 0;
+		}
+
+		if (finishFrame() != 0) {
+			return -1;
+		}
+		compression_ = mode;
+		return 0;
+	}
+
+	void ZLogFileWriter::markUnsynced(int mode) {
+		if (mode > unsyncedMode_) {
+			unsyncedMode_ = mode;
+		}
+	}
+
+	int ZLogFileWriter::getUnsyncedMode() const {
+		return unsyncedMode_;
+	}
+
+	bool ZLogFileWriter::isOpen() const {
+		return fd_ >= 0;
+	}
+
+	int ZLogFileWriter::getFd() const {
+		return fd_;
+	}
+
+	const std::string& ZLogFileWriter::getPath() const {
+		return path_;
+	}
+
+	size_t ZLogFileWriter::getBufferSize() const {
+		return bufferSize_;
+	}
+
+	size_t ZLogFileWriter::getFileSize() const {
+		return fileOffset_ + bufferUsed_;
+	}
+
+	int ZLogFileWriter::refreshFileSize() {
+		if (fd_ < 0) {
+			return -1;
+		}
+
+		ZLOG_STAT_STRUCT st;
+		if (ZLOG_FSTAT(fd_, &st) != 0) {
+			lastError_ = errno;
+			return -1;
+		}
+
+		fileOffset_ = static_cast<size_t>(st.st_size);
+		if (allocatedEnd_ < fileOffset_) {
+			allocatedEnd_ = fileOffset_;
+		}
+		lastSizeRefresh_ = std::chrono::steady_clock::now();
+		return 0;
+	}
+
+	int ZLogFileWriter::refreshFileSize(int minIntervalMs) {
+		if (std::chrono::steady_clock::now() - lastSizeRefresh_ < std::chrono::milliseconds(minIntervalMs)) {
+			return 0;
+		}
+		return refreshFileSize();
+	}
+
+	int ZLogFileWriter::getLastError() const {
+		return lastError_;
+	}
+
+	std::string ZLogFileWriter::getLastErrorString() const {
+		if (lastError_ == 0) {
+			return "";
+		}
+#ifdef _WIN32
+		char buf[128];
+		strerror_s(buf, sizeof(buf), lastError_);
+		return std::string(buf) + " (errno " + std::to_string(lastError_) + ")";
+#else
+		return std::string(std::strerror(lastError_)) + " (errno " + std::to_string(lastError_) + ")";
+#endif
+	}
+
+	bool ZLogFileWriter::shouldReportError() {
+		if (lastError_ == 0 || lastError_ == reportedError_) {
+			return false;
+		}
+		reportedError_ = lastError_;
+		return true;
+	}
+
+	int ZLogFileWriter::writeFrame(const char* data, size_t size) {
+		if (compression_ == COMPRESS_NONE) {
+			return writeAll(data, size);
+		}
+
+		if (compressStream_.write(compression_, data, size, frameBuffer_) != 0) {
+			lastError_ = EIO;
+			return -1;
+		}
+		return writeAll(frameBuffer_.data(), frameBuffer_.size());
+	}
+
+	int ZLogFileWriter::finishFrame() {
+		if (flush() != 0) {
+			return -1;
+		}
+		if (compression_ == COMPRESS_NONE || fd_ < 0 || !compressStream_.isFrameOpen()) {
+			return 0;
+		}
+
+		if (compressStream_.finish(frameBuffer_) != 0) {
+			lastError_ = EIO;
+			return -1;
+		}
+		return writeAll(frameBuffer_.data(), frameBuffer_.size());
+	}
+
+	int ZLogFileWriter::writeAll(const char* data, size_t size) {
+		if (preallocateSize_ > 0 && fileOffset_ + size > allocatedEnd_) {
+			preallocate(size);
+		}
+
+		while (size > 0) {
+			auto ret = ZLOG_WRITE(fd_, data, size);
+			if (ret < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				lastError_ = errno;
+				return -1;
+			}
+			data += ret;
+			size -= static_cast<size_t>(ret);
+			fileOffset_ += static_cast<size_t>(ret);
+		}
+		return 0;
+	}
+
+	void ZLogFileWriter::preallocate(size_t size) {
+#if defined(__linux__)
+		size_t extent = std::max(preallocateSize_, size);
+		off_t offset = static_cast<off_t>(std::max(fileOffset_, allocatedEnd_));
+		if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset, static_cast<off_t>(extent)) == 0) {
+			allocatedEnd_ = static_cast<size_t>(offset) + extent;
+		}
+		else {
+			preallocateSize_ = 0;
+		}
+#else
+		(void)size;
+		preallocateSize_ = 0;
+#endif
+	}
+
+	void ZLogFileWriter::releasePreallocation() {
+#if defined(__linux__)
+		if (allocatedEnd_ > fileOffset_) {
+			ZLOG_STAT_STRUCT st;
+			if (ZLOG_FSTAT(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == fileOffset_) {
+				if (::ftruncate(fd_, st.st_size) != 0) {
+					lastError_ = errno;
+				}
+			}
+		}
+#endif
+		allocatedEnd_ = fileOffset_;
+	}
+
+	int ZLogFileWriter::allocateBuffer(size_t size) {
+		if (size == bufferSize_ && (buffer_ != nullptr || size == 0)) {
+			return 0;
+		}
+
+		releaseBuffer();
+		if (size == 0) {
+			return 0;
+		}
+
+		size_t alignedSize = (size + ZLOG_BUFFER_ALIGNMENT - 1) / ZLOG_BUFFER_ALIGNMENT * ZLOG_BUFFER_ALIGNMENT;
+
+#ifdef _WIN32
+		buffer_ = static_cast<char*>(_aligned_malloc(alignedSize, ZLOG_BUFFER_ALIGNMENT));
+		if (buffer_ == nullptr) {
+			lastError_ = ENOMEM;
+			return -1;
+		}
+#else
+		void* ptr = nullptr;
+		int ret = posix_memalign(&ptr, ZLOG_BUFFER_ALIGNMENT, alignedSize);
+		if (ret != 0) {
+			lastError_ = ret;
+			return -1;
+		}
+		buffer_ = static_cast<char*>(ptr);
+#endif
+
+		bufferSize_ = size;
+		bufferUsed_ = 0;
+		return 0;
+	}
+
+	void ZLogFileWriter::releaseBuffer() {
+		if (buffer_ != nullptr) {
+#ifdef _WIN32
+			_aligned_free(buffer_);
+#else
+			std::free(buffer_);
+#endif
+		}
+		buffer_ = nullptr;
+		bufferSize_ = 0;
+		bufferUsed_ = 0;
+	}
+
+	ZLogFileCache::ZLogFileCache()
+		: maxFiles_(DEFAULT_FILE_CACHE_SIZE)
+		, idleTimeoutMs_(DEFAULT_FILE_IDLE_TIMEOUT_MS) {
+	}
+
+	ZLogFileCache::~ZLogFileCache() {
+		closeAll();
+	}
+
+	void ZLogFileCache::setErrorHandler(std::function<void(ZLogFileWriter&, const std::string&)> handler) {
+		errorHandler_ = std::move(handler);
+	}
+
+	int ZLogFileCache::setLimits(size_t maxFiles, int idleTimeoutMs) {
+		if (idleTimeoutMs < 0) {
+			return -1;
+		}
+
+		maxFiles_ = maxFiles;
+		idleTimeoutMs_ = idleTimeoutMs;
+		trim();
+		return 0;
+	}
+
+	std::unique_ptr<ZLogFileWriter>& ZLogFileCache::acquire(const std::string& path) {
+		auto now = std::chrono::steady_clock::now();
+
+		auto it = entries_.begin();
+		while (it != entries_.end() && it->path != path) {
+			++it;
+		}
+
+		if (it == entries_.end()) {
+			entries_.emplace_front();
+			it = entries_.begin();
+			it->path = path;
+			it->lastCheck = now;
+		}
+		else if (it != entries_.begin()) {
+			entries_.splice(entries_.begin(), entries_, it);
+		}
+
+		if (it->writer && it->writer->isOpen() &&
+			now - it->lastCheck >= std::chrono::milliseconds(DEFAULT_FILE_CHECK_INTERVAL_MS)) {
+			if (isStale(*it->writer)) {
+				closeWriter(it->writer);
+			}
+			it->lastCheck = now;
+		}
+
+		it->lastUsed = now;
+		return it->writer;
+	}
+
+	std::unique_ptr<ZLogFileWriter>* ZLogFileCache::find(const std::string& path) {
+		for (auto& entry : entries_) {
+			if (entry.path == path) {
+				return &entry.writer;
+			}
+		}
+		return nullptr;
+	}
+
+	void ZLogFileCache::trim() {
+		while (entries_.size() > maxFiles_) {
+			closeWriter(entries_.back().writer);
+			entries_.pop_back();
+		}
+	}
+
+	void ZLogFileCache::closeIdle() {
+		if (entries_.empty()) {
+			return;
+		}
+
+		auto deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(idleTimeoutMs_);
+		while (!entries_.empty() && entries_.back().lastUsed <= deadline) {
+			closeWriter(entries_.back().writer);
+			entries_.pop_back();
+		}
+	}
+
+	void ZLogFileCache::closeAll() {
+		for (auto& entry : entries_) {
+			closeWriter(entry.writer);
+		}
+		entries_.clear();
+	}
+
+	void ZLogFileCache::forEach(const std::function<void(ZLogFileWriter&)>& fn) {
+		for (auto& entry : entries_) {
+			if (entry.writer && entry.writer->isOpen()) {
+				fn(*entry.writer);
+			}
+		}
+	}
+
+	void ZLogFileCache::forEachRaw(void (*fn)(ZLogFileWriter&, void*), void* context) {
+		for (auto& entry : entries_) {
+			if (entry.writer && entry.writer->isOpen()) {
+				fn(*entry.writer, context);
+			}
+		}
+	}
+
+	size_t ZLogFileCache::getOpenCount() const {
+		return entries_.size();
+	}
+
+	int ZLogFileCache::getIdleTimeout() const {
+		return idleTimeoutMs_;
+	}
+
+	bool ZLogFileCache::isStale(const ZLogFileWriter& writer) const {
+#ifdef _WIN32
+		(void)writer;
+		return false;
+#else
+		ZLOG_STAT_STRUCT opened;
+		ZLOG_STAT_STRUCT current;
+		if (ZLOG_FSTAT(writer.getFd(), &opened) != 0 || ::stat(writer.getPath().c_str(), &current) != 0) {
+			return true;
+		}
+		return opened.st_dev != current.st_dev || opened.st_ino != current.st_ino;
+#endif
+	}
+
+	void ZLogFileCache::closeWriter(std::unique_ptr<ZLogFileWriter>& writer) {
+		if (writer && writer->close() != 0 && errorHandler_) {
+			errorHandler_(*writer, "close");
+		}
+		writer.reset();
+	}
+
+} // namespace zlog
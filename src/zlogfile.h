@@ -0,0 +1,123 @@
+#ifndef __ZLOG_FILE__
+#define __ZLOG_FILE__
+
+#include <string>
+#include <list>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <cstddef>
+
+#include "zlogcompress.h"
+
+namespace zlog {
+
+	static const size_t ZLOG_BUFFER_ALIGNMENT = 4096;
+	static const size_t DEFAULT_FILE_CACHE_SIZE = 16;
+	static const int DEFAULT_FILE_IDLE_TIMEOUT_MS = 5000;
+	static const int DEFAULT_FILE_CHECK_INTERVAL_MS = 1000;
+
+	class ZLogFileWriter {
+	public:
+		ZLogFileWriter();
+		~ZLogFileWriter();
+
+		ZLogFileWriter(const ZLogFileWriter&) = delete;
+		ZLogFileWriter& operator=(const ZLogFileWriter&) = delete;
+
+		int open(const std::string& path, size_t bufferSize);
+		int write(const char* data, size_t size);
+		int writeDirect(const char* data, size_t size);
+		int flush();
+		int sync();
+		int close();
+
+		int setBufferSize(size_t size);
+		int setPreallocateSize(size_t size);
+		int setCompression(ZLogCompression mode);
+
+		void markUnsynced(int mode);
+		int getUnsyncedMode() const;
+
+		bool isOpen() const;
+		int getFd() const;
+		const std::string& getPath() const;
+		size_t getBufferSize() const;
+		size_t getFileSize() const;
+		int refreshFileSize();
+		int refreshFileSize(int minIntervalMs);
+
+		int getLastError() const;
+		std::string getLastErrorString() const;
+		bool shouldReportError();
+
+	private:
+		int writeFrame(const char* data, size_t size);
+		int finishFrame();
+		int writeAll(const char* data, size_t size);
+		void preallocate(size_t size);
+		void releasePreallocation();
+		int allocateBuffer(size_t size);
+		void releaseBuffer();
+
+	private:
+		int fd_;
+		std::string path_;
+		char* buffer_;
+		size_t bufferSize_;
+		size_t bufferUsed_;
+		size_t fileOffset_;
+		size_t allocatedEnd_;
+		size_t preallocateSize_;
+		std::chrono::steady_clock::time_point lastSizeRefresh_;
+		int unsyncedMode_;
+		ZLogCompression compression_;
+		ZLogCompressStream compressStream_;
+		std::string frameBuffer_;
+		int lastError_;
+		int reportedError_;
+	};
+
+	class ZLogFileCache {
+	public:
+		ZLogFileCache();
+		~ZLogFileCache();
+
+		ZLogFileCache(const ZLogFileCache&) = delete;
+		ZLogFileCache& operator=(const ZLogFileCache&) = delete;
+
+		void setErrorHandler(std::function<void(ZLogFileWriter&, const std::string&)> handler);
+		int setLimits(size_t maxFiles, int idleTimeoutMs);
+
+		std::unique_ptr<ZLogFileWriter>& acquire(const std::string& path);
+		std::unique_ptr<ZLogFileWriter>* find(const std::string& path);
+		void trim();
+		void closeIdle();
+		void closeAll();
+		void forEach(const std::function<void(ZLogFileWriter&)>& fn);
+		void forEachRaw(void (*fn)(ZLogFileWriter&, void*), void* context);
+
+		size_t getOpenCount() const;
+		int getIdleTimeout() const;
+
+	private:
+		struct Entry {
+			std::string path;
+			std::unique_ptr<ZLogFileWriter> writer;
+			std::chrono::steady_clock::time_point lastUsed;
+			std::chrono::steady_clock::time_point lastCheck;
+		};
+
+		bool isStale(const ZLogFileWriter& writer) const;
+		void closeWriter(std::unique_ptr<ZLogFileWriter>& writer);
+
+	private:
+		std::list<Entry> entries_;
+		size_t maxFiles_;
+		int idleTimeoutMs_;
+		std::function<void(ZLogFileWriter&, const std::string&)> errorHandler_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_FILE__
@@ -4,55 +4,137 @@
 #include <direct.h>
 #include <io.h>
 #include <sys/stat.h>
+#include <process.h>
 #define ACCESS _access
 #define MKDIR(path) _mkdir(path)
 #define STAT _stat
 #define STAT_STRUCT struct _stat
+#define GETPID _getpid
 #else
 #include <unistd.h>
 #include <sys/stat.h>
+#if defined(__linux__)
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 #define ACCESS access
 #define MKDIR(path) mkdir(path, 0755)
 #define STAT stat
 #define STAT_STRUCT struct stat
+#define GETPID getpid
 #endif
 
 namespace zlog {
 
 	std::unique_ptr<ZLogging> ZLogging::instance_ = nullptr;
 	std::once_flag ZLogging::initFlag_;
+	std::mutex ZLogging::registryMutex_;
+	std::map<std::string, std::unique_ptr<ZLogging>> ZLogging::registry_;
+	std::array<std::atomic<ZLogging*>, MAX_CRASH_LOGGERS> ZLogging::crashLoggers_ = {};
 
 	thread_local std::string ZLogging::tlsFormatBuffer_;
 	thread_local std::string ZLogging::tlsTimestampBuffer_;
 	thread_local std::string ZLogging::tlsFilenameBuffer_;
-
-	ZLogging::ZLogging()
-		: stopWorker_(false)
+	thread_local ZLogging* ZLogging::tlsCommitting_ = nullptr;
+
+	ZLogging::ZLogging(const std::string& name)
+		: name_(name)
+		, workerPool_(name.empty() ? nullptr : &ZLogWorkerPool::getShared())
+		, workerParked_(false)
+		, workerSpinUs_(DEFAULT_WORKER_SPIN_US)
+		, workerAffinity_(-1)
+		, workerPriority_(0)
+		, workerTuneDirty_(false)
+		, stopWorker_(false)
 		, initialized_(false)
+		, workerBusy_(false)
+		, crashState_(0)
+		, crashDeadlineMs_(DEFAULT_CRASH_DEADLINE_MS)
+		, crashUtcOffset_(0)
 		, outputMode_(ZLOG_DEFAULT_MODE)
 		, fileMode_(ALWAYS_OPEN)
 		, minLevel_(ZLOG_INFO)
+		, backtraceCapacity_(0)
+		, backtraceTrigger_(ZLOG_ERROR)
+		, backtraceIndex_(0)
+		, backtraceTaken_(0)
 		, singleFileOutput_(false)
 		, singleFileLevel_(ZLOG_INFO)
 		, singleFilePath_("")
-		, programName_(DEFAULT_PROGRAM_NAME)
-		, outputDir_(DEFAULT_OUTPUT_DIR)
+		, syslogFacility_(DEFAULT_SYSLOG_FACILITY)
+		, hostName_("-")
+		, tcpFormat_(TCP_FORMAT_TEXT)
+		, spoolMaxSize_(DEFAULT_SPOOL_MAX_SIZE)
+		, shmCapacity_(DEFAULT_SHM_CAPACITY)
+		, memoryMaxRecords_(DEFAULT_MEMORY_MAX_RECORDS)
+		, memoryMaxBytes_(DEFAULT_MEMORY_MAX_BYTES)
+		, programName_(name.empty() ? DEFAULT_PROGRAM_NAME : name)
+		, outputDir_(name.empty() ? DEFAULT_OUTPUT_DIR : DEFAULT_OUTPUT_DIR + "/" + name)
 		, maxLogSize_(DEFAULT_MAX_LOG_SIZE)
 		, maxCacheSize_(DEFAULT_MAX_CACHE_SIZE)
 		, maxBufferSize_(DEFAULT_MAX_BUFFER_SIZE)
 		, rotatePolicy_(NO_ROTATE)
+		, rotateInterval_(DEFAULT_ROTATE_INTERVAL)
+		, rotateOffset_(0)
+		, singleRotateBoundary_(0)
+		, preallocateSize_(DEFAULT_PREALLOCATE_SIZE)
+		, rotateCompression_(COMPRESS_NONE)
+		, streamCompression_(COMPRESS_NONE)
+		, freshFileCounter_(0)
+		, syncIntervalMs_(DEFAULT_SYNC_INTERVAL_MS)
+		, lastSyncTime_(std::chrono::steady_clock::now())
+		, durableSequence_(0)
 		, totalLogCount_(0)
 		, sequenceCounter_(0)
 		, droppedMessageCount_(0)
-		, lastRotateTime_(0) {
+		, sampledOutCount_(0)
+		, queueDepth_(0)
+		, queueDepthPeak_(0)
+		, maxQueueBytes_(0)
+		, queuedBytes_(0)
+		, queueBytes_(0)
+		, queueBytesPeak_(0)
+		, metricsIntervalMs_(DEFAULT_METRICS_INTERVAL_MS)
+		, lastMetricsExport_(std::chrono::steady_clock::now())
+		, hasSuppressionSites_(false)
+		, lastSuppressionCheck_(std::chrono::steady_clock::now()) {
 
 		for (int i = ZLOG_TRACE; i <= ZLOG_FATAL; ++i) {
 			levelLogCounts_[static_cast<ZLogLevel>(i)] = 0;
 		}
 
+		durability_.fill(DURABILITY_NONE);
+		waitDurable_.fill(false);
+		synchronous_.fill(false);
+		for (auto& threshold : sampleThresholds_) {
+			threshold.store(ZLOG_SAMPLE_ALWAYS);
+		}
+		resetRotateBoundaries();
+
+#ifndef _WIN32
+		char host[256];
+		if (gethostname(host, sizeof(host)) == 0) {
+			host[sizeof(host) - 1] = '\0';
+			hostName_ = host;
+		}
+#endif
+
+		rotator_.setErrorHandler([this](const std::string& msg) {
+			if (initialized_.load()) {
+				logInternal(ZLOG_ERROR, std::string(msg), __FILE__, __FUNCTION__, __LINE__);
+			}
+			});
+
+		fileCache_.setErrorHandler([this](ZLogFileWriter& writer, const std::string& action) {
+			reportFileError(writer, action);
+			});
 	}
 
 	ZLogging::~ZLogging() {
+		uninstallCrashHandler();
 		shutdown();
 	}
 
@@ -63,6 +145,19 @@ namespace zlog {
 		return *instance_;
 	}
 
+	ZLogging& ZLogging::getInstance(const std::string& name) {
+		if (name.empty()) {
+			return getInstance();
+		}
+
+		std::lock_guard<std::mutex> lock(registryMutex_);
+		auto it = registry_.find(name);
+		if (it == registry_.end()) {
+			it = registry_.emplace(name, std::unique_ptr<ZLogging>(new ZLogging(name))).first;
+		}
+		return *it->second;
+	}
+
 	int ZLogging::initialize() {
 		std::lock_guard<std::mutex> lock(configMutex_);
 		if (initialized_.load()) {
@@ -73,7 +168,21 @@ namespace zlog {
 		initializeFilePaths();
 
 		stopWorker_.store(false);
-		asyncWorker_ = std::thread(&ZLogging::runAsyncWorker, this);
+		if (workerPool_) {
+			workerClient_ = workerPool_->attach([this] {
+				return runWorkerBatch();
+				}, [this] {
+				return getWorkerWaitTimeout();
+				});
+		}
+		else {
+			asyncWorker_ = std::thread(&ZLogging::runAsyncWorker, this);
+		}
+
+		std::vector<std::string> recoveryErrors;
+		if (outputMode_ & FILE_OUT) {
+			recoveryErrors = rotator_.recoverFreshFiles(getManagedFilePaths());
+		}
 
 		if ((outputMode_ & FILE_OUT) && (fileMode_ == ALWAYS_OPEN)) {
 			openLogFiles();
@@ -81,8 +190,28 @@ namespace zlog {
 
 		initialized_.store(true);
 
+		for (auto& error : recoveryErrors) {
+			logInternal(ZLOG_ERROR, std::move(error), __FILE__, __FUNCTION__, __LINE__);
+		}
+
+		if (outputMode_ & SYSLOG_OUT) {
+			openSyslog();
+		}
+
+		if (outputMode_ & TCP_OUT) {
+			openTcp();
+		}
+
+		if (outputMode_ & SHM_OUT) {
+			openShm();
+		}
+
+		if (outputMode_ & MEMORY_OUT) {
+			openMemory();
+		}
+
 		std::this_thread::sleep_for(std::chrono::milliseconds(10));
-		logDirect(ZLOG_DEBUG, "ZLogging system initialized successfully", __FILE__, __FUNCTION__, __LINE__);
+		logInternal(ZLOG_DEBUG, "ZLogging system initialized successfully", __FILE__, __FUNCTION__, __LINE__);
 
 		return 0;
 	}
@@ -109,11 +238,11 @@ namespace zlog {
 		std::string oldDir = outputDir_;
 		outputDir_ = dir;
 
-		for (auto& pair : filePaths_) {
-			size_t pos = pair.second.find_last_of("/\\");
+		for (auto& path : filePaths_) {
+			size_t pos = path.find_last_of("/\\");
 			if (pos != std::string::npos) {
-				std::string filename = pair.second.substr(pos + 1);
-				pair.second = outputDir_ + "/" + filename;
+				std::string filename = path.substr(pos + 1);
+				path = outputDir_ + "/" + filename;
 			}
 		}
 
@@ -156,12 +285,45 @@ namespace zlog {
 		return 0;
 	}
 
+	int ZLogging::setMaxQueueBytes(size_t bytes) {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		maxQueueBytes_ = bytes;
+		return 0;
+	}
+
+	int ZLogging::setMaxQueueBytesFromCgroup(double fraction) {
+		if (!(fraction > 0.0 && fraction <= 1.0)) {
+			return -1;
+		}
+
+		size_t limit = getCgroupMemoryLimit();
+		if (limit == 0) {
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		maxQueueBytes_ = std::max<size_t>(static_cast<size_t>(limit * fraction), 1);
+		return 0;
+	}
+
 	int ZLogging::setMaxBufferSize(size_t size) {
 		std::lock_guard<std::mutex> lock(configMutex_);
 		if (size == 0) {
 			return -1;
 		}
 		maxBufferSize_ = size;
+
+		if (initialized_.load()) {
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
+			if (singleFileWriter_) {
+				singleFileWriter_->setBufferSize(maxBufferSize_);
+			}
+			for (auto& writer : fileWriters_) {
+				if (writer) {
+					writer->setBufferSize(maxBufferSize_);
+				}
+			}
+		}
 		return 0;
 	}
 
@@ -173,7 +335,7 @@ namespace zlog {
 
 	int ZLogging::setLevelFile(ZLogLevel level, const std::string& fileName) {
 		std::lock_guard<std::mutex> lock(configMutex_);
-		if (fileName.empty()) {
+		if (fileName.empty() || level < ZLOG_TRACE || level > ZLOG_FATAL) {
 			return -1;
 		}
 
@@ -189,27 +351,7 @@ namespace zlog {
 
 		if (initialized_.load() && (outputMode_ & FILE_OUT) && (fileMode_ == ALWAYS_OPEN) && !singleFileOutput_) {
 			std::lock_guard<std::mutex> fileLock(fileMutex_);
-
-			auto it = fileStreams_.find(level);
-			if (it != fileStreams_.end() && it->second) {
-				it->second->close();
-			}
-
-			size_t pos = fullPath.find_last_of("/\\");
-			if (pos != std::string::npos) {
-				std::string dir = fullPath.substr(0, pos);
-				if (!pathExists(dir)) {
-					createDirectoryRecursive(dir);
-				}
-			}
-
-			fileStreams_[level] = std::make_shared<std::ofstream>(fullPath, std::ios::app);
-			if (fileStreams_[level]->is_open()) {
-				fileStreams_[level]->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-			}
-			else {
-				fileStreams_[level].reset();
-			}
+			openFileWriter(fullPath, fileWriters_[level]);
 		}
 
 		return 0;
@@ -223,9 +365,8 @@ namespace zlog {
 		singleFileLevel_ = level;
 
 		if (singleFile) {
-			auto it = filePaths_.find(level);
-			if (it != filePaths_.end()) {
-				singleFilePath_ = it->second;
+			if (level >= ZLOG_TRACE && level <= ZLOG_FATAL && !filePaths_[level].empty()) {
+				singleFilePath_ = filePaths_[level];
 			}
 			else {
 				singleFilePath_ = outputDir_ + "/" + DEFAULT_OUTPUT_FILE;
@@ -233,6 +374,22 @@ namespace zlog {
 		}
 
 		if (initialized_.load()) {
+			if (mode & SYSLOG_OUT) {
+				openSyslog();
+			}
+
+			if (mode & TCP_OUT) {
+				openTcp();
+			}
+
+			if (mode & SHM_OUT) {
+				openShm();
+			}
+
+			if (mode & MEMORY_OUT) {
+				openMemory();
+			}
+
 			std::lock_guard<std::mutex> fileLock(fileMutex_);
 
 			if (mode & FILE_OUT) {
@@ -268,6 +425,22 @@ namespace zlog {
 		}
 
 		if (initialized_.load()) {
+			if (mode & SYSLOG_OUT) {
+				openSyslog();
+			}
+
+			if (mode & TCP_OUT) {
+				openTcp();
+			}
+
+			if (mode & SHM_OUT) {
+				openShm();
+			}
+
+			if (mode & MEMORY_OUT) {
+				openMemory();
+			}
+
 			std::lock_guard<std::mutex> fileLock(fileMutex_);
 
 			if (mode & FILE_OUT) {
@@ -299,6 +472,7 @@ namespace zlog {
 				closeLogFiles();
 			}
 			else if (oldMode == OPEN_ON_WRITE && mode == ALWAYS_OPEN) {
+				fileCache_.closeAll();
 				openLogFiles();
 			}
 		}
@@ -309,390 +483,1782 @@ namespace zlog {
 	int ZLogging::setRotatePolicy(ZLogRotatePolicy policy) {
 		std::lock_guard<std::mutex> lock(configMutex_);
 		rotatePolicy_ = policy;
+		resetRotateBoundaries();
 		return 0;
 	}
 
-	void ZLogging::writeLog(const ZLogEntry& entry) {
-		if (!initialized_.load() || !shouldOutput(entry.level)) {
-			return;
+	int ZLogging::setRotateInterval(int intervalSeconds, int offsetSeconds) {
+		if (intervalSeconds <= 0 || offsetSeconds < 0 || offsetSeconds >= ZLOG_SECONDS_PER_DAY) {
+			return -1;
 		}
 
-		ZLogEntry entryCopy = entry;
-		entryCopy.sequence = sequenceCounter_.fetch_add(1) + 1;
-
-		{
-			std::lock_guard<std::mutex> queueLock(queueMutex_);
+		std::lock_guard<std::mutex> lock(configMutex_);
+		rotateInterval_ = intervalSeconds;
+		rotateOffset_ = offsetSeconds;
+		resetRotateBoundaries();
+		return 0;
+	}
 
-			totalLogCount_.fetch_add(1);
-			levelLogCounts_[entry.level].fetch_add(1);
+	int ZLogging::setConsoleNonBlocking(bool enable, size_t maxBacklog) {
+		std::lock_guard<std::mutex> consoleLock(consoleMutex_);
+		return consoleSink_.setNonBlocking(enable, maxBacklog);
+	}
 
-			if (messageQueue_.size() >= maxCacheSize_) {
-				droppedMessageCount_.fetch_add(1);
-				return;
-			}
+	int ZLogging::setSyslogTarget(const std::string& target, int facility) {
+		if (target.empty() || facility < 0 || facility > 23) {
+			return -1;
+		}
 
-			messageQueue_.push_back(std::move(entryCopy));
+		{
+			std::lock_guard<std::mutex> lock(configMutex_);
+			syslogTarget_ = target;
+			syslogFacility_ = facility;
 		}
 
-		queueCondition_.notify_one();
+		std::lock_guard<std::mutex> syslogLock(syslogMutex_);
+		return syslogSink_.open(target);
 	}
 
-	void ZLogging::writeLog(ZLogEntry&& entry) {
-		if (!initialized_.load() || !shouldOutput(entry.level)) {
-			return;
+	int ZLogging::setTcpTarget(const std::string& target, ZLogTcpFormat format) {
+		if (target.empty() || (format != TCP_FORMAT_TEXT && format != TCP_FORMAT_JSON)) {
+			return -1;
 		}
 
-		entry.sequence = sequenceCounter_.fetch_add(1) + 1;
-		ZLogLevel level = entry.level;
-
 		{
-			std::lock_guard<std::mutex> queueLock(queueMutex_);
-
-			totalLogCount_.fetch_add(1);
-			levelLogCounts_[level].fetch_add(1);
+			std::lock_guard<std::mutex> lock(configMutex_);
+			tcpTarget_ = target;
+			tcpFormat_ = format;
+		}
 
-			if (messageQueue_.size() >= maxCacheSize_) {
-				droppedMessageCount_.fetch_add(1);
-				return;
+		{
+			std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+			if (tcpSink_.close() != 0 && initialized_.load()) {
+				logInternal(ZLOG_ERROR, "Failed to save TCP spool in " + tcpSink_.getSpoolDirectory(), __FILE__, __FUNCTION__, __LINE__);
 			}
-
-			messageQueue_.emplace_back(std::move(entry));
 		}
 
-		queueCondition_.notify_one();
-	}
-
-	void ZLogging::logDirect(ZLogLevel level, const std::string& msg, const std::string& filePath, const std::string& function, int line) {
-		if (!shouldOutput(level)) {
-			return;
+		if (initialized_.load()) {
+			openTcp();
 		}
-		ZLogEntry entry(level, msg, filePath, function, line);
-		writeLog(std::move(entry));
+		return 0;
 	}
 
-	void ZLogging::logDirect(ZLogLevel level, std::string&& msg, const std::string& filePath, const std::string& function, int line) {
-		if (!shouldOutput(level)) {
-			return;
+	int ZLogging::setSpoolDirectory(const std::string& dir, size_t maxSize) {
+		if (dir.empty() || maxSize == 0) {
+			return -1;
 		}
-		ZLogEntry entry(level, std::move(msg), filePath, function, line);
-		writeLog(std::move(entry));
-	}
 
-	ZLogStream ZLogging::createStream(ZLogLevel level, const std::string& filePath, const std::string& functionName, int line) {
-		return ZLogStream(this, level, filePath, functionName, line);
+		std::lock_guard<std::mutex> lock(configMutex_);
+		spoolDir_ = dir;
+		spoolMaxSize_ = maxSize;
+		return 0;
 	}
 
-	void ZLogging::flush() {
-		auto startTime = std::chrono::steady_clock::now();
-		const auto timeout = std::chrono::milliseconds(1000);
-
-		while (true) {
-			{
-				std::lock_guard<std::mutex> queueLock(queueMutex_);
-				if (messageQueue_.empty()) {
-					break;
-				}
-			}
-
-			if (std::chrono::steady_clock::now() - startTime > timeout) {
-				break;
-			}
+	int ZLogging::setShmTarget(const std::string& name, size_t capacity) {
+		if (name.empty() || capacity == 0) {
+			return -1;
+		}
 
-			queueCondition_.notify_one();
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		{
+			std::lock_guard<std::mutex> lock(configMutex_);
+			shmName_ = name;
+			shmCapacity_ = capacity;
 		}
 
-		if (fileMode_ == ALWAYS_OPEN) {
-			std::lock_guard<std::mutex> fileLock(fileMutex_);
+		{
+			std::lock_guard<std::mutex> shmLock(shmMutex_);
+			shmSink_.close();
+		}
 
-			if (singleFileOutput_ && singleFileStream_ && singleFileStream_->is_open()) {
-				singleFileStream_->flush();
-			}
-			else {
-				for (auto& stream : fileStreams_) {
-					if (stream.second && stream.second->is_open()) {
-						stream.second->flush();
-					}
-				}
-			}
+		if (initialized_.load()) {
+			openShm();
 		}
+		return 0;
 	}
 
-	void ZLogging::shutdown(int timeoutMs) {
-		if (!initialized_.load()) {
-			return;
+	int ZLogging::setMemoryTarget(size_t maxRecords, size_t maxBytes) {
+		if (maxRecords == 0) {
+			return -1;
 		}
 
-		initialized_.store(false);
-
-		auto startTime = std::chrono::steady_clock::now();
-		auto timeout = std::chrono::milliseconds(timeoutMs);
+		std::lock_guard<std::mutex> lock(configMutex_);
+		std::lock_guard<std::mutex> memoryLock(memoryMutex_);
+		if (memorySink_.isOpen()) {
+			return -1;
+		}
 
-		while (true) {
-			{
-				std::lock_guard<std::mutex> queueLock(queueMutex_);
-				if (messageQueue_.empty()) {
-					break;
-				}
-			}
+		memoryMaxRecords_ = maxRecords;
+		memoryMaxBytes_ = maxBytes;
+		return 0;
+	}
 
-			if (std::chrono::steady_clock::now() - startTime > timeout) {
-				std::lock_guard<std::mutex> queueLock(queueMutex_);
-				size_t remaining = messageQueue_.size();
-				if (remaining > 0) {
-					droppedMessageCount_.fetch_add(remaining);
-					messageQueue_.clear();
-				}
-				break;
-			}
+	int ZLogging::setWorkerPool(ZLogWorkerPool* pool) {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (initialized_.load()) {
+			return -1;
+		}
+		workerPool_ = pool;
+		return 0;
+	}
 
-			queueCondition_.notify_one();
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	int ZLogging::setWorkerSpin(int spinUs) {
+		if (spinUs < 0 || spinUs > MAX_WORKER_SPIN_US) {
+			return -1;
 		}
 
-		stopWorker_.store(true);
-		queueCondition_.notify_one();
+		std::lock_guard<std::mutex> lock(configMutex_);
+		workerSpinUs_ = spinUs;
+		return 0;
+	}
 
-		if (asyncWorker_.joinable()) {
-			asyncWorker_.join();
+	int ZLogging::setWorkerAffinity(int cpu) {
+#if defined(__linux__)
+		if (cpu < -1 || cpu >= CPU_SETSIZE) {
+			return -1;
 		}
 
-		{
-			std::lock_guard<std::mutex> fileLock(fileMutex_);
-			closeLogFiles();
+		std::lock_guard<std::mutex> lock(configMutex_);
+		workerAffinity_ = cpu;
+		workerTuneDirty_.store(true);
+		if (initialized_.load()) {
+			wakeWorker();
 		}
+		return 0;
+#else
+		(void)cpu;
+		return -1;
+#endif
 	}
 
-	void ZLogging::rotateLogFiles() {
-		std::lock_guard<std::mutex> lock(fileMutex_);
-
-		if (singleFileOutput_) {
-			if (singleFileStream_ && singleFileStream_->is_open()) {
-				singleFileStream_->close();
-
-				std::string newFileName = generateRotatedFileName(singleFilePath_);
-				if (std::rename(singleFilePath_.c_str(), newFileName.c_str()) == 0) {
-					singleFileStream_ = std::make_shared<std::ofstream>(singleFilePath_, std::ios::app);
-					if (singleFileStream_->is_open()) {
-						singleFileStream_->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-					}
-				}
-			}
+	int ZLogging::setWorkerPriority(int priority) {
+#if defined(__linux__)
+		if (priority < -20 || priority > 19) {
+			return -1;
 		}
-		else {
-			for (auto& pair : fileStreams_) {
-				ZLogLevel level = pair.first;
-				auto& stream = pair.second;
-
-				if (stream && stream->is_open()) {
-					stream->close();
-
-					auto it = filePaths_.find(level);
-					if (it != filePaths_.end()) {
-						std::string newFileName = generateRotatedFileName(it->second);
-						if (std::rename(it->second.c_str(), newFileName.c_str()) == 0) {
-							stream = std::make_shared<std::ofstream>(it->second, std::ios::app);
-							if (stream->is_open()) {
-								stream->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-							}
-						}
-					}
-				}
-			}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		workerPriority_ = priority;
+		workerTuneDirty_.store(true);
+		if (initialized_.load()) {
+			wakeWorker();
 		}
+		return 0;
+#else
+		(void)priority;
+		return -1;
+#endif
 	}
 
-	bool ZLogging::isInitialized() const {
-		return initialized_.load();
-	}
+	int ZLogging::setSampleRate(ZLogLevel level, double rate) {
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return -1;
+		}
+		if (!(rate >= 0.0 && rate <= 1.0)) {
+			return -1;
+		}
 
-	bool ZLogging::shouldOutput(ZLogLevel level) const {
-		return initialized_.load() && level >= minLevel_;
+		sampleThresholds_[level].store(ZLogSampler::toThreshold(rate), std::memory_order_relaxed);
+		return 0;
 	}
 
-	std::string ZLogging::getOutputDirectory() const {
+	int ZLogging::setBacktrace(size_t capacity, ZLogLevel triggerLevel) {
 		std::lock_guard<std::mutex> lock(configMutex_);
-		return outputDir_;
-	}
+		if (initialized_.load()) {
+			return -1;
+		}
+		if (capacity > MAX_BACKTRACE_CAPACITY || triggerLevel < ZLOG_TRACE || triggerLevel > ZLOG_FATAL) {
+			return -1;
+		}
 
-	std::string ZLogging::getLogFilePath(ZLogLevel level) const {
-		std::lock_guard<std::mutex> lock(configMutex_);
-		auto it = filePaths_.find(level);
-		return (it != filePaths_.end()) ? it->second : "";
+		backtraceSlots_.reset(capacity > 0 ? new ZLogBacktraceSlot[capacity] : nullptr);
+		backtraceCapacity_ = capacity;
+		backtraceTrigger_ = triggerLevel;
+		backtraceIndex_.store(0);
+		backtraceTaken_.store(0);
+		return 0;
 	}
 
-	std::string ZLogging::getUnifiedLogFilePath() const {
-		std::lock_guard<std::mutex> lock(configMutex_);
-		return singleFileOutput_ ? singleFilePath_ : "";
-	}
+	int ZLogging::setMetricsExport(const std::string& path, int intervalMs) {
+		if (intervalMs <= 0) {
+			return -1;
+		}
 
-	int ZLogging::getOutputMode() const {
 		std::lock_guard<std::mutex> lock(configMutex_);
-		return outputMode_;
+		if (initialized_.load()) {
+			return -1;
+		}
+
+		metricsPath_ = path;
+		metricsIntervalMs_ = intervalMs;
+		return 0;
 	}
 
-	ZLogLevel ZLogging::getMinLevel() const {
+	int ZLogging::setSiteStats(bool enable) {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (initialized_.load()) {
+			return -1;
+		}
+
+		if (!enable) {
+			siteTable_.reset();
+		}
+		else if (!siteTable_) {
+			siteTable_.reset(new ZLogSiteTable());
+		}
+		return 0;
+	}
+
+	int ZLogging::setDurability(ZLogLevel level, ZLogDurability mode, bool waitDurable) {
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return -1;
+		}
+		if (mode != DURABILITY_NONE && mode != DURABILITY_PERIODIC && mode != DURABILITY_GROUP_COMMIT) {
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		durability_[level] = mode;
+		waitDurable_[level] = waitDurable && (mode == DURABILITY_GROUP_COMMIT);
+		if (initialized_.load()) {
+			wakeWorker();
+		}
+		return 0;
+	}
+
+	int ZLogging::setSynchronous(ZLogLevel level, bool enable) {
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		synchronous_[level] = enable;
+		return 0;
+	}
+
+	int ZLogging::setFormatThreads(size_t count) {
+		std::lock_guard<std::mutex> commitLock(commitMutex_);
+		return formatPool_.start(count);
+	}
+
+	int ZLogging::setSyncInterval(int intervalMs) {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (intervalMs <= 0) {
+			return -1;
+		}
+		syncIntervalMs_ = intervalMs;
+		return 0;
+	}
+
+	int ZLogging::setPreallocateSize(size_t size) {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		preallocateSize_ = size;
+
+		if (initialized_.load()) {
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
+			if (singleFileWriter_) {
+				singleFileWriter_->setPreallocateSize(preallocateSize_);
+			}
+			for (auto& writer : fileWriters_) {
+				if (writer) {
+					writer->setPreallocateSize(preallocateSize_);
+				}
+			}
+		}
+		return 0;
+	}
+
+	int ZLogging::setRotateCompression(ZLogCompression mode) {
+		if (!ZLogCompressor::isSupported(mode)) {
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		rotateCompression_ = mode;
+		return 0;
+	}
+
+	int ZLogging::setStreamCompression(ZLogCompression mode) {
+		if (!ZLogCompressor::isSupported(mode)) {
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(configMutex_);
+		streamCompression_ = mode;
+
+		if (initialized_.load()) {
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
+			if (singleFileWriter_) {
+				singleFileWriter_->setCompression(streamCompression_);
+			}
+			for (auto& writer : fileWriters_) {
+				if (writer) {
+					writer->setCompression(streamCompression_);
+				}
+			}
+		}
+		return 0;
+	}
+
+	int ZLogging::setRetention(size_t maxFiles, int maxAgeSeconds, size_t maxTotalBytes) {
+		if (maxAgeSeconds < 0) {
+			return -1;
+		}
+
+		ZLogRetention retention;
+		retention.maxFiles = maxFiles;
+		retention.maxAgeSeconds = maxAgeSeconds;
+		retention.maxTotalBytes = maxTotalBytes;
+		rotator_.setRetention(retention);
+		return 0;
+	}
+
+	int ZLogging::setFileCache(size_t maxFiles, int idleTimeoutMs) {
+		std::lock_guard<std::mutex> fileLock(fileMutex_);
+		return fileCache_.setLimits(maxFiles, idleTimeoutMs);
+	}
+
+	void ZLogging::writeLog(const ZLogEntry& entry) {
+		if (!initialized_.load() || !shouldOutput(entry.level)) {
+			return;
+		}
+
+		ZLogEntry entryCopy = entry;
+		writeLog(std::move(entryCopy));
+	}
+
+	void ZLogging::writeLog(ZLogEntry&& entry) {
+		if (!initialized_.load() || !shouldOutput(entry.level)) {
+			return;
+		}
+
+		if (entry.level < minLevel_) {
+			recordBacktrace(std::move(entry));
+			return;
+		}
+
+		if (siteTable_) {
+			siteTable_->record(entry.filePath, entry.lineNumber, entry.message);
+		}
+
+		if (backtraceCapacity_ > 0 && entry.level >= backtraceTrigger_) {
+			std::vector<ZLogEntry> backtrace = takeBacktrace();
+			if (!backtrace.empty()) {
+				enqueueBatch(std::move(backtrace));
+			}
+		}
+
+		if (synchronous_[entry.level] && tlsCommitting_ != this) {
+			writeLogSync(std::move(entry));
+		}
+		else {
+			enqueueLog(std::move(entry));
+		}
+	}
+
+	void ZLogging::enqueueLog(ZLogEntry&& entry) {
+		ZLogLevel level = entry.level;
+		size_t sequence = 0;
+		bool wake = false;
+
+		{
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+
+			totalLogCount_.fetch_add(1);
+			levelLogCounts_[level].fetch_add(1);
+
+			size_t entryBytes = getEntryBytes(entry);
+			if (messageQueue_.size() >= maxCacheSize_ ||
+				(maxQueueBytes_ > 0 && !messageQueue_.empty() && queuedBytes_ + entryBytes > maxQueueBytes_)) {
+				droppedMessageCount_.fetch_add(1);
+				return;
+			}
+
+			if (workerClient_) {
+				wake = messageQueue_.empty();
+			}
+			else if (workerParked_) {
+				workerParked_ = false;
+				wake = true;
+			}
+			sequence = appendQueued(std::move(entry), entryBytes);
+		}
+
+		if (wake) {
+			wakeWorker();
+		}
+
+		if (durability_[level] == DURABILITY_GROUP_COMMIT && waitDurable_[level]) {
+			waitDurable(sequence);
+		}
+	}
+
+	size_t ZLogging::enqueueBatch(std::vector<ZLogEntry>&& entries) {
+		size_t sequence = 0;
+		bool wake = false;
+
+		{
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+
+			if (workerClient_) {
+				wake = messageQueue_.empty();
+			}
+			else if (workerParked_) {
+				workerParked_ = false;
+				wake = true;
+			}
+
+			for (auto& entry : entries) {
+				totalLogCount_.fetch_add(1);
+				levelLogCounts_[entry.level].fetch_add(1);
+				size_t entryBytes = getEntryBytes(entry);
+				sequence = appendQueued(std::move(entry), entryBytes);
+			}
+		}
+
+		if (wake) {
+			wakeWorker();
+		}
+		return sequence;
+	}
+
+	size_t ZLogging::appendQueued(ZLogEntry&& entry, size_t entryBytes) {
+		size_t sequence = sequenceCounter_.fetch_add(1) + 1;
+		entry.sequence = sequence;
+		entry.enqueueTime = std::chrono::steady_clock::now();
+		messageQueue_.emplace_back(std::move(entry));
+
+		size_t depth = messageQueue_.size();
+		queueDepth_.store(depth, std::memory_order_relaxed);
+		if (depth > queueDepthPeak_.load(std::memory_order_relaxed)) {
+			queueDepthPeak_.store(depth, std::memory_order_relaxed);
+		}
+
+		queuedBytes_ += entryBytes;
+		queueBytes_.store(queuedBytes_, std::memory_order_relaxed);
+		if (queuedBytes_ > queueBytesPeak_.load(std::memory_order_relaxed)) {
+			queueBytesPeak_.store(queuedBytes_, std::memory_order_relaxed);
+		}
+		return sequence;
+	}
+
+	void ZLogging::writeLogSync(ZLogEntry&& entry) {
+		{
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+			if (crashState_.load() != 0) {
+				return;
+			}
+
+			totalLogCount_.fetch_add(1);
+			levelLogCounts_[entry.level].fetch_add(1);
+
+			entry.sequence = sequenceCounter_.fetch_add(1) + 1;
+			syncBarriers_.push_back(entry.sequence);
+		}
+
+		waitCommitted(entry.sequence - 1, -1);
+
+		{
+			std::lock_guard<std::mutex> commitLock(commitMutex_);
+			if (crashState_.load() == 0) {
+				ZLogging* previous = tlsCommitting_;
+				tlsCommitting_ = this;
+				workerBusy_.store(true);
+
+				processLogEntry(entry);
+				flushSinks();
+				if (outputMode_ & FILE_OUT) {
+					flushFileWriters();
+				}
+				commitDurable(entry.sequence);
+
+				workerBusy_.store(false);
+				tlsCommitting_ = previous;
+			}
+		}
+
+		bool wake = false;
+		{
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+			syncBarriers_.erase(std::find(syncBarriers_.begin(), syncBarriers_.end(), entry.sequence));
+			wake = hasReadyEntries();
+		}
+		if (wake) {
+			wakeWorker();
+		}
+	}
+
+	void ZLogging::logDirect(ZLogLevel level, const std::string& msg, const std::string& filePath, const std::string& function, int line) {
+		if (!shouldOutput(level)) {
+			return;
+		}
+		ZLogEntry entry(level, msg, filePath, function, line);
+		writeLog(std::move(entry));
+	}
+
+	void ZLogging::logDirect(ZLogLevel level, std::string&& msg, const std::string& filePath, const std::string& function, int line) {
+		if (!shouldOutput(level)) {
+			return;
+		}
+		ZLogEntry entry(level, std::move(msg), filePath, function, line);
+		writeLog(std::move(entry));
+	}
+
+	void ZLogging::addSuppressionSite(const ZLogSuppressionSite& site) {
+		std::lock_guard<std::mutex> lock(suppressionMutex_);
+		suppressionSites_.push_back(site);
+		hasSuppressionSites_.store(true);
+	}
+
+	void ZLogging::reportSuppressed(bool force) {
+		if (!hasSuppressionSites_.load()) {
+			return;
+		}
+
+		std::vector<ZLogEntry> summaries;
+		{
+			std::lock_guard<std::mutex> lock(suppressionMutex_);
+			for (const auto& site : suppressionSites_) {
+				uint64_t suppressed = 0;
+				int64_t suppressedNs = 0;
+				if (site.takeExpired(site.site, force, suppressed, suppressedNs)) {
+					summaries.emplace_back(site.level, formatSuppressedSummary(suppressed, suppressedNs),
+						site.filePath, site.functionName, site.line);
+				}
+			}
+		}
+
+		for (auto& entry : summaries) {
+			writeLog(std::move(entry));
+		}
+	}
+
+	void ZLogging::logInternal(ZLogLevel level, std::string&& msg, const std::string& filePath, const std::string& function, int line) {
+		if (!initialized_.load() || level < minLevel_) {
+			return;
+		}
+		enqueueLog(ZLogEntry(level, std::move(msg), filePath, function, line));
+	}
+
+	void ZLogging::recordBacktrace(ZLogEntry&& entry) {
+		uint64_t stamp = backtraceIndex_.fetch_add(1, std::memory_order_relaxed) + 1;
+		ZLogBacktraceSlot& slot = backtraceSlots_[stamp % backtraceCapacity_];
+
+		while (slot.busy.exchange(true, std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+		if (stamp > slot.stamp) {
+			slot.entry = std::move(entry);
+			slot.stamp = stamp;
+		}
+		slot.busy.store(false, std::memory_order_release);
+	}
+
+	std::vector<ZLogMemoryRecord> ZLogging::queryMemory(const ZLogMemoryQuery& query) const {
+		return memorySink_.query(query);
+	}
+
+	void ZLogging::clearMemory() {
+		std::lock_guard<std::mutex> memoryLock(memoryMutex_);
+		memorySink_.clear();
+	}
+
+	void ZLogging::dumpBacktrace() {
+		if (!initialized_.load() || backtraceCapacity_ == 0) {
+			return;
+		}
+
+		std::vector<ZLogEntry> batch = takeBacktrace();
+		if (!batch.empty()) {
+			enqueueBatch(std::move(batch));
+		}
+	}
+
+	std::vector<ZLogEntry> ZLogging::takeBacktrace() {
+		std::vector<ZLogEntry> batch;
+		uint64_t index = backtraceIndex_.load(std::memory_order_acquire);
+		if (index == backtraceTaken_.load(std::memory_order_relaxed)) {
+			return batch;
+		}
+		backtraceTaken_.store(index, std::memory_order_relaxed);
+
+		std::vector<std::pair<uint64_t, ZLogEntry>> entries;
+		for (size_t i = 0; i < backtraceCapacity_; ++i) {
+			ZLogBacktraceSlot& slot = backtraceSlots_[i];
+			while (slot.busy.exchange(true, std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			if (slot.stamp != 0) {
+				entries.emplace_back(slot.stamp, std::move(slot.entry));
+				slot.stamp = 0;
+			}
+			slot.busy.store(false, std::memory_order_release);
+		}
+
+		if (entries.empty()) {
+			return batch;
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const std::pair<uint64_t, ZLogEntry>& a, const std::pair<uint64_t, ZLogEntry>& b) {
+			return a.first < b.first;
+			});
+
+		batch.reserve(entries.size() + 3);
+		batch.emplace_back(minLevel_, "backtrace begin: " + std::to_string(entries.size()) + " entries", __FILE__, __FUNCTION__, __LINE__);
+		for (auto& entry : entries) {
+			batch.emplace_back(std::move(entry.second));
+		}
+		batch.emplace_back(minLevel_, "backtrace end", __FILE__, __FUNCTION__, __LINE__);
+		return batch;
+	}
+
+	ZLogStream ZLogging::createStream(ZLogLevel level, const std::string& filePath, const std::string& functionName, int line) {
+		return ZLogStream(this, level, filePath, functionName, line);
+	}
+
+	int ZLogging::flush(int timeoutMs) {
+		reportSuppressed(true);
+
+		int ret = 0;
+		if (tlsCommitting_ != this && !waitCommitted(sequenceCounter_.load(), timeoutMs)) {
+			ret = -1;
+		}
+
+		flushSinks();
+		flushFileWriters();
+		return ret;
+	}
+
+	int ZLogging::shutdown(int timeoutMs) {
+		if (!initialized_.load()) {
+			return 0;
+		}
+
+		reportSuppressed(true);
+		initialized_.store(false);
+
+		int ret = 0;
+		if (!waitCommitted(sequenceCounter_.load(), timeoutMs)) {
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+			size_t remaining = messageQueue_.size();
+			if (remaining > 0) {
+				droppedMessageCount_.fetch_add(remaining);
+				messageQueue_.clear();
+				queueDepth_.store(0, std::memory_order_relaxed);
+				queuedBytes_ = 0;
+				queueBytes_.store(0, std::memory_order_relaxed);
+				ret = -1;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> queueLock(queueMutex_);
+			stopWorker_.store(true);
+		}
+		queueCondition_.notify_one();
+		durableCondition_.notify_all();
+
+		if (workerClient_) {
+			workerPool_->detach(workerClient_);
+			drainQueue();
+		}
+		if (asyncWorker_.joinable()) {
+			asyncWorker_.join();
+		}
+		formatPool_.stop();
+
+		{
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
+			closeLogFiles();
+		}
+
+		{
+			std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+			if (tcpSink_.close() != 0) {
+				ret = -1;
+			}
+		}
+
+		rotator_.stop();
+		return ret;
+	}
+
+	void ZLogging::rotateLogFiles() {
+		std::lock_guard<std::mutex> lock(fileMutex_);
+
+		if (singleFileOutput_) {
+			bool active = (fileMode_ == ALWAYS_OPEN) ? (singleFileWriter_ && singleFileWriter_->isOpen()) : pathExists(singleFilePath_);
+			if (active) {
+				rotateFile(singleFileLevel_);
+			}
+		}
+		else {
+			for (int i = ZLOG_TRACE; i <= ZLOG_FATAL; ++i) {
+				const auto& writer = fileWriters_[i];
+				bool active = (fileMode_ == ALWAYS_OPEN) ? (writer && writer->isOpen()) : pathExists(filePaths_[i]);
+				if (active && !filePaths_[i].empty()) {
+					rotateFile(static_cast<ZLogLevel>(i));
+				}
+			}
+		}
+	}
+
+	int ZLogging::installCrashHandler(int deadlineMs) {
+		if (deadlineMs < 0) {
+			return -1;
+		}
+
+		std::time_t now = std::time(nullptr);
+		struct tm localTm;
+		struct tm utcTm;
+#ifdef _WIN32
+		bool ok = (localtime_s(&localTm, &now) == 0 && gmtime_s(&utcTm, &now) == 0);
+#else
+		bool ok = (localtime_r(&now, &localTm) != nullptr && gmtime_r(&now, &utcTm) != nullptr);
+#endif
+		if (ok) {
+			int dayDiff = (localTm.tm_year != utcTm.tm_year) ? ((localTm.tm_year > utcTm.tm_year) ? 1 : -1)
+				: (localTm.tm_yday - utcTm.tm_yday);
+			crashUtcOffset_ = dayDiff * static_cast<long>(ZLOG_SECONDS_PER_DAY)
+				+ (localTm.tm_hour - utcTm.tm_hour) * 3600L + (localTm.tm_min - utcTm.tm_min) * 60L
+				+ (localTm.tm_sec - utcTm.tm_sec);
+		}
+
+		crashDeadlineMs_ = deadlineMs;
+
+		bool registered = false;
+		for (auto& slot : crashLoggers_) {
+			ZLogging* expected = nullptr;
+			if (slot.load() == this || slot.compare_exchange_strong(expected, this)) {
+				registered = true;
+				break;
+			}
+		}
+		if (!registered) {
+			return -1;
+		}
+		return ZLogCrashHandler::install(&ZLogging::onCrashSignal);
+	}
+
+	void ZLogging::uninstallCrashHandler() {
+		bool remaining = false;
+		for (auto& slot : crashLoggers_) {
+			ZLogging* expected = this;
+			slot.compare_exchange_strong(expected, nullptr);
+			if (slot.load() != nullptr) {
+				remaining = true;
+			}
+		}
+
+		if (!remaining) {
+			ZLogCrashHandler::uninstall();
+		}
+	}
+
+	void ZLogging::onCrashSignal(int signal) {
+		for (auto& slot : crashLoggers_) {
+			ZLogging* logger = slot.load();
+			if (logger) {
+				logger->handleCrash(signal);
+			}
+		}
+	}
+
+	void ZLogging::handleCrash(int signal) {
+		int expected = 0;
+		if (!crashState_.compare_exchange_strong(expected, 1)) {
+			int64_t deadline = ZLogCrashHandler::monotonicMs() + crashDeadlineMs_;
+			while (crashState_.load() == 1 && ZLogCrashHandler::monotonicMs() < deadline) {
+				ZLogCrashHandler::sleepMs(1);
+			}
+			return;
+		}
+
+		if (!initialized_.load()) {
+			crashState_.store(2);
+			return;
+		}
+
+		ZLogCrashHandler::armWatchdog(crashDeadlineMs_);
+		int64_t deadline = ZLogCrashHandler::monotonicMs() + crashDeadlineMs_;
+		bool isWorker = (tlsCommitting_ == this);
+
+		bool queueLocked = queueMutex_.try_lock();
+		while (!queueLocked && ZLogCrashHandler::monotonicMs() < deadline) {
+			ZLogCrashHandler::sleepMs(1);
+			queueLocked = queueMutex_.try_lock();
+		}
+
+		while (!isWorker && workerBusy_.load() && ZLogCrashHandler::monotonicMs() < deadline) {
+			ZLogCrashHandler::sleepMs(1);
+		}
+
+		bool fileLocked = fileMutex_.try_lock();
+		while (!fileLocked && !isWorker && ZLogCrashHandler::monotonicMs() < deadline) {
+			ZLogCrashHandler::sleepMs(1);
+			fileLocked = fileMutex_.try_lock();
+		}
+
+		std::array<int, ZLOG_LEVEL_COUNT> openedFds;
+		openedFds.fill(-1);
+
+		ZLogCrashLine line;
+		size_t queued = 0;
+		size_t flushed = 0;
+		if (queueLocked) {
+			queued = messageQueue_.size();
+			for (const auto& entry : messageQueue_) {
+				if (ZLogCrashHandler::monotonicMs() >= deadline) {
+					break;
+				}
+				formatCrashLine(entry, line);
+				writeCrashLine(entry.level, line, openedFds);
+				++flushed;
+			}
+		}
+
+		line.clear();
+		line.append("[");
+		line.appendTimestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count(), crashUtcOffset_);
+		line.append("] [FATAL] [-] [zlogging] Crash: caught ");
+		line.append(ZLogCrashHandler::getSignalName(signal));
+		line.append(" (signal ");
+		line.appendNumber(static_cast<uint64_t>(signal));
+		line.append("), flushed ");
+		line.appendNumber(flushed);
+		line.append(" of ");
+		line.appendNumber(queued);
+		line.append(" queued log entries");
+		line.endLine();
+
+		auto finishWriter = [&line](ZLogFileWriter& writer) {
+			if (writer.writeDirect(line.data(), line.size()) == 0) {
+				writer.sync();
+			}
+			};
+
+		if (outputMode_ & FILE_OUT) {
+			if (singleFileWriter_ && singleFileWriter_->isOpen()) {
+				finishWriter(*singleFileWriter_);
+			}
+			for (auto& writer : fileWriters_) {
+				if (writer && writer->isOpen()) {
+					finishWriter(*writer);
+				}
+			}
+			fileCache_.forEachRaw([](ZLogFileWriter& writer, void* context) {
+				const ZLogCrashLine& crashLine = *static_cast<const ZLogCrashLine*>(context);
+				if (writer.writeDirect(crashLine.data(), crashLine.size()) == 0) {
+					writer.sync();
+				}
+				}, &line);
+			for (int fd : openedFds) {
+				if (fd >= 0) {
+					ZLogCrashHandler::writeAll(fd, line.data(), line.size());
+					ZLogCrashHandler::syncAndClose(fd);
+				}
+			}
+		}
+		ZLogCrashHandler::writeAll(2, line.data(), line.size());
+
+		crashState_.store(2);
+	}
+
+	void ZLogging::writeCrashLine(ZLogLevel level, const ZLogCrashLine& line, std::array<int, ZLOG_LEVEL_COUNT>& openedFds) {
+		if ((outputMode_ & FILE_OUT) && (singleFileOutput_ || (level >= ZLOG_TRACE && level <= ZLOG_FATAL))) {
+			const std::string& filePath = singleFileOutput_ ? singleFilePath_ : filePaths_[level];
+
+			ZLogFileWriter* writer = nullptr;
+			if (fileMode_ == ALWAYS_OPEN) {
+				writer = getFileWriter(level);
+			}
+			else {
+				std::unique_ptr<ZLogFileWriter>* cached = fileCache_.find(filePath);
+				writer = cached ? cached->get() : nullptr;
+			}
+
+			if (writer && writer->isOpen()) {
+				if (writer->writeDirect(line.data(), line.size()) == 0) {
+					return;
+				}
+			}
+			else if (!filePath.empty() && streamCompression_ == COMPRESS_NONE) {
+				int& fd = openedFds[singleFileOutput_ ? 0 : level];
+				if (fd < 0) {
+					fd = ZLogCrashHandler::openAppend(filePath.c_str());
+				}
+				if (fd >= 0 && ZLogCrashHandler::writeAll(fd, line.data(), line.size()) == 0) {
+					return;
+				}
+			}
+		}
+
+		ZLogCrashHandler::writeAll(2, line.data(), line.size());
+	}
+
+	void ZLogging::formatCrashLine(const ZLogEntry& entry, ZLogCrashLine& line) const {
+		line.clear();
+		line.append("[");
+		line.appendTimestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+			entry.timestamp.time_since_epoch()).count(), crashUtcOffset_);
+		line.append("] [");
+		line.append(getLevelName(entry.level));
+		line.append("] [-] [");
+
+		size_t pos = entry.filePath.find_last_of("/\\");
+		line.append(entry.filePath.c_str() + ((pos == std::string::npos) ? 0 : pos + 1));
+		if (entry.lineNumber > 0) {
+			line.append(":");
+			line.appendNumber(static_cast<uint64_t>(entry.lineNumber));
+		}
+		line.append("]");
+
+		if (!entry.functionName.empty()) {
+			line.append(" [");
+			line.append(entry.functionName.data(), entry.functionName.size());
+			line.append("]");
+		}
+
+		if (entry.sequence > 0) {
+			line.append(" #");
+			line.appendNumber(entry.sequence);
+		}
+
+		line.append(" ");
+		line.append(entry.message.data(), entry.message.size());
+		line.endLine();
+	}
+
+	bool ZLogging::isInitialized() const {
+		return initialized_.load();
+	}
+
+	const std::string& ZLogging::getName() const {
+		return name_;
+	}
+
+	bool ZLogging::shouldOutput(ZLogLevel level) const {
+		return initialized_.load() && (level >= minLevel_ || backtraceCapacity_ > 0);
+	}
+
+	bool ZLogging::shouldSample(ZLogLevel level) {
+		uint64_t threshold = sampleThresholds_[level].load(std::memory_order_relaxed);
+		if (threshold >= ZLOG_SAMPLE_ALWAYS) {
+			return true;
+		}
+		return recordSample(ZLogSampler::sample(threshold));
+	}
+
+	bool ZLogging::recordSample(bool sampled) {
+		if (!sampled) {
+			sampledOutCount_.fetch_add(1, std::memory_order_relaxed);
+		}
+		return sampled;
+	}
+
+	std::string ZLogging::getOutputDirectory() const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		return outputDir_;
+	}
+
+	std::string ZLogging::getLogFilePath(ZLogLevel level) const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return "";
+		}
+		return filePaths_[level];
+	}
+
+	std::string ZLogging::getUnifiedLogFilePath() const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		return singleFileOutput_ ? singleFilePath_ : "";
+	}
+
+	int ZLogging::getOutputMode() const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		return outputMode_;
+	}
+
+	ZLogLevel ZLogging::getMinLevel() const {
 		std::lock_guard<std::mutex> lock(configMutex_);
 		return minLevel_;
 	}
 
-	ZLogFileMode ZLogging::getFileMode() const {
+	ZLogFileMode ZLogging::getFileMode() const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		return fileMode_;
+	}
+
+	ZLogDurability ZLogging::getDurability(ZLogLevel level) const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return DURABILITY_NONE;
+		}
+		return durability_[level];
+	}
+
+	bool ZLogging::isSynchronous(ZLogLevel level) const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return false;
+		}
+		return synchronous_[level];
+	}
+
+	double ZLogging::getSampleRate(ZLogLevel level) const {
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return 0.0;
+		}
+		return ZLogSampler::toRate(sampleThresholds_[level].load(std::memory_order_relaxed));
+	}
+
+	size_t ZLogging::getMaxCacheSize() const {
+		std::lock_guard<std::mutex> lock(configMutex_);
+		return maxCacheSize_;
+	}
+
+	size_t ZLogging::getQueueSize() const {
+		std::lock_guard<std::mutex> lock(queueMutex_);
+		return messageQueue_.size();
+	}
+
+	size_t ZLogging::getQueueDepthPeak() const {
+		return queueDepthPeak_.load();
+	}
+
+	size_t ZLogging::getQueueBytes() const {
+		return queueBytes_.load();
+	}
+
+	size_t ZLogging::getQueueBytesPeak() const {
+		return queueBytesPeak_.load();
+	}
+
+	size_t ZLogging::getMaxQueueBytes() const {
 		std::lock_guard<std::mutex> lock(configMutex_);
-		return fileMode_;
+		return maxQueueBytes_;
+	}
+
+	size_t ZLogging::getEntryBytes(const ZLogEntry& entry) {
+		return sizeof(ZLogEntry) + entry.message.size() + entry.filePath.size() + entry.functionName.size();
+	}
+
+	size_t ZLogging::getCgroupMemoryLimit() {
+#ifdef __linux__
+		const char* paths[] = {
+			"/sys/fs/cgroup/memory.max",
+			"/sys/fs/cgroup/memory/memory.limit_in_bytes"
+		};
+
+		for (const char* path : paths) {
+			std::ifstream input(path);
+			std::string value;
+			if (!(input >> value) || value == "max") {
+				continue;
+			}
+
+			char* end = nullptr;
+			unsigned long long limit = std::strtoull(value.c_str(), &end, 10);
+			if (end != value.c_str() && *end == '\0' && limit > 0 && limit < (1ULL << 62)) {
+				return static_cast<size_t>(limit);
+			}
+		}
+#endif
+		return 0;
+	}
+
+	ZLogMetrics ZLogging::getMetrics() const {
+		ZLogMetrics metrics;
+		metrics.queueLatencyNs = queueLatencyHistogram_.snapshot();
+		metrics.formatNs = formatHistogram_.snapshot();
+		metrics.writeNs = writeHistogram_.snapshot();
+		metrics.batchSize = batchSizeHistogram_.snapshot();
+		metrics.queueDepth = queueDepth_.load();
+		metrics.queueDepthPeak = queueDepthPeak_.load();
+		metrics.queueBytes = queueBytes_.load();
+		metrics.queueBytesPeak = queueBytesPeak_.load();
+		metrics.totalCount = totalLogCount_.load();
+		metrics.droppedCount = droppedMessageCount_.load();
+		metrics.sampledOutCount = sampledOutCount_.load();
+		return metrics;
+	}
+
+	std::string ZLogging::formatMetrics() const {
+		return formatPrometheusMetrics(name_.empty() ? "default" : name_, getMetrics());
+	}
+
+	ZLogSiteReport ZLogging::reportTopSites(size_t count) {
+		if (!siteTable_) {
+			return ZLogSiteReport();
+		}
+		return siteTable_->report(count);
+	}
+
+	void ZLogging::exportMetrics() {
+		std::string tempPath = metricsPath_ + ".tmp";
+		std::string text = formatMetrics();
+
+		std::ofstream output(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+		output.write(text.data(), text.size());
+		output.close();
+
+		bool ok = output.good();
+		if (ok) {
+#ifdef _WIN32
+			std::remove(metricsPath_.c_str());
+#endif
+			ok = std::rename(tempPath.c_str(), metricsPath_.c_str()) == 0;
+		}
+
+		if (!ok) {
+			std::remove(tempPath.c_str());
+			logInternal(ZLOG_ERROR, "Failed to export metrics to " + metricsPath_, __FILE__, __FUNCTION__, __LINE__);
+		}
+	}
+
+	size_t ZLogging::getTotalLogCount() const {
+		return totalLogCount_.load();
+	}
+
+	size_t ZLogging::getLogCount(ZLogLevel level) const {
+		auto it = levelLogCounts_.find(level);
+		return (it != levelLogCounts_.end()) ? it->second.load() : 0;
+	}
+
+	size_t ZLogging::getDroppedMessageCount() const {
+		return droppedMessageCount_.load();
+	}
+
+	size_t ZLogging::getSampledOutCount() const {
+		return sampledOutCount_.load();
+	}
+
+	size_t ZLogging::getConsoleDroppedCount() const {
+		return consoleSink_.getDroppedCount();
+	}
+
+	size_t ZLogging::getSyslogSentCount() const {
+		return syslogSink_.getSentCount();
+	}
+
+	size_t ZLogging::getSyslogDroppedCount() const {
+		return syslogSink_.getDroppedCount();
+	}
+
+	size_t ZLogging::getTcpSentCount() const {
+		return tcpSink_.getSentCount();
+	}
+
+	size_t ZLogging::getTcpSpooledCount() const {
+		return tcpSink_.getSpooledCount();
+	}
+
+	size_t ZLogging::getTcpDroppedCount() const {
+		return tcpSink_.getDroppedCount();
+	}
+
+	size_t ZLogging::getMemoryRecordCount() const {
+		return memorySink_.getRecordCount();
+	}
+
+	size_t ZLogging::getMemoryEvictedCount() const {
+		return memorySink_.getEvictedCount();
+	}
+
+	size_t ZLogging::getShmDroppedCount() const {
+		std::lock_guard<std::mutex> shmLock(shmMutex_);
+		return shmSink_.getDroppedCount();
+	}
+
+	void ZLogging::runAsyncWorker() {
+		while (!stopWorker_.load()) {
+			if (workerTuneDirty_.exchange(false)) {
+				applyWorkerTuning();
+			}
+
+			int timeoutMs = getWorkerWaitTimeout();
+
+			{
+				std::unique_lock<std::mutex> lock(queueMutex_);
+				if (messageQueue_.empty() && workerSpinUs_ > 0) {
+					size_t seenSequence = sequenceCounter_.load();
+					lock.unlock();
+					spinForWork(seenSequence);
+					lock.lock();
+				}
+
+				auto ready = [this] {
+					return hasReadyEntries() || stopWorker_.load() || workerTuneDirty_.load();
+					};
+
+				if (!ready()) {
+					workerParked_ = true;
+					if (timeoutMs > 0) {
+						queueCondition_.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+					}
+					else {
+						queueCondition_.wait(lock, ready);
+					}
+					workerParked_ = false;
+				}
+			}
+
+			runWorkerBatch();
+			if (crashState_.load() != 0) {
+				return;
+			}
+		}
+
+		drainQueue();
+	}
+
+	bool ZLogging::runWorkerBatch() {
+		ZLogging* previous = tlsCommitting_;
+		tlsCommitting_ = this;
+
+		std::unique_lock<std::mutex> commitLock(commitMutex_);
+		std::unique_lock<std::mutex> lock(queueMutex_);
+		if (crashState_.load() != 0) {
+			tlsCommitting_ = previous;
+			return false;
+		}
+
+		size_t formatThreads = formatPool_.getThreadCount();
+		size_t batchLimit = (formatThreads > 0) ? DEFAULT_FORMAT_CHUNK_SIZE * (formatThreads + 1) * 4 : 100;
+
+		std::vector<ZLogEntry> batch;
+		batch.reserve(std::min(messageQueue_.size(), batchLimit));
+
+		while (hasReadyEntries() && batch.size() < batchLimit) {
+			queuedBytes_ -= std::min(queuedBytes_, getEntryBytes(messageQueue_.front()));
+			batch.emplace_back(std::move(messageQueue_.front()));
+			messageQueue_.pop_front();
+		}
+		queueDepth_.store(messageQueue_.size(), std::memory_order_relaxed);
+		queueBytes_.store(queuedBytes_, std::memory_order_relaxed);
+		workerBusy_.store(true);
+		lock.unlock();
+
+		auto dequeueTime = std::chrono::steady_clock::now();
+		for (const auto& entry : batch) {
+			auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(dequeueTime - entry.enqueueTime).count();
+			queueLatencyHistogram_.record(waited > 0 ? static_cast<uint64_t>(waited) : 0);
+		}
+
+		auto formatStart = std::chrono::steady_clock::now();
+		auto writeStart = formatStart;
+		if (formatThreads > 0 || (outputMode_ & (FILE_OUT | SHM_OUT | MEMORY_OUT))) {
+			renderBatch(batch);
+			writeStart = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < batch.size(); ++i) {
+				processLogEntry(batch[i], &renderedBatch_[i]);
+			}
+		}
+		else {
+			for (const auto& entry : batch) {
+				processLogEntry(entry);
+			}
+		}
+
+		flushSinks();
+		if (!batch.empty() && (outputMode_ & FILE_OUT)) {
+			flushFileWriters();
+		}
+
+		if (!batch.empty()) {
+			auto writeEnd = std::chrono::steady_clock::now();
+			formatHistogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(writeStart - formatStart).count());
+			writeHistogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(writeEnd - writeStart).count());
+			batchSizeHistogram_.record(batch.size());
+		}
+
+		if (!batch.empty()) {
+			commitDurable(batch.back().sequence);
+		}
+
+		if (fileMode_ == OPEN_ON_WRITE) {
+			closeIdleFiles();
+		}
+
+		workerBusy_.store(false);
+		commitLock.unlock();
+
+		if (hasPeriodicSync() &&
+			std::chrono::steady_clock::now() - lastSyncTime_ >= std::chrono::milliseconds(syncIntervalMs_)) {
+			syncLogFiles(DURABILITY_PERIODIC);
+			lastSyncTime_ = std::chrono::steady_clock::now();
+		}
+
+		if (!metricsPath_.empty() &&
+			std::chrono::steady_clock::now() - lastMetricsExport_ >= std::chrono::milliseconds(metricsIntervalMs_)) {
+			exportMetrics();
+			lastMetricsExport_ = std::chrono::steady_clock::now();
+		}
+
+		if (hasSuppressionSites_.load() &&
+			std::chrono::steady_clock::now() - lastSuppressionCheck_ >= std::chrono::milliseconds(DEFAULT_SUPPRESSION_CHECK_MS)) {
+			reportSuppressed(false);
+			lastSuppressionCheck_ = std::chrono::steady_clock::now();
+		}
+
+		tlsCommitting_ = previous;
+
+		lock.lock();
+		return hasReadyEntries();
+	}
+
+	bool ZLogging::hasReadyEntries() const {
+		return !messageQueue_.empty() &&
+			(syncBarriers_.empty() || messageQueue_.front().sequence < syncBarriers_.front());
+	}
+
+	void ZLogging::drainQueue() {
+		ZLogging* previous = tlsCommitting_;
+		tlsCommitting_ = this;
+
+		std::unique_lock<std::mutex> commitLock(commitMutex_);
+		std::unique_lock<std::mutex> lock(queueMutex_);
+		while (!messageQueue_.empty()) {
+			ZLogEntry entry = std::move(messageQueue_.front());
+			messageQueue_.pop_front();
+			processLogEntry(entry);
+		}
+		queueDepth_.store(0, std::memory_order_relaxed);
+		queuedBytes_ = 0;
+		queueBytes_.store(0, std::memory_order_relaxed);
+		lock.unlock();
+
+		flushSinks();
+		if (outputMode_ & FILE_OUT) {
+			flushFileWriters();
+		}
+
+		syncLogFiles(DURABILITY_PERIODIC);
+		commitDurable(sequenceCounter_.load());
+
+		if (!metricsPath_.empty()) {
+			exportMetrics();
+		}
+
+		tlsCommitting_ = previous;
+	}
+
+	void ZLogging::spinForWork(size_t seenSequence) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(workerSpinUs_);
+		size_t spins = 0;
+
+		while (sequenceCounter_.load() == seenSequence && !stopWorker_.load()) {
+			if (++spins % 64 == 0 && std::chrono::steady_clock::now() >= deadline) {
+				break;
+			}
+			if (spins > 1024) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void ZLogging::applyWorkerTuning() {
+#if defined(__linux__)
+		int cpu = -1;
+		int priority = 0;
+		{
+			std::lock_guard<std::mutex> lock(configMutex_);
+			cpu = workerAffinity_;
+			priority = workerPriority_;
+		}
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		if (cpu >= 0) {
+			CPU_SET(cpu, &cpus);
+		}
+		else if (sched_getaffinity(GETPID(), sizeof(cpus), &cpus) != 0) {
+			CPU_ZERO(&cpus);
+		}
+
+		if (CPU_COUNT(&cpus) > 0) {
+			int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+			if (ret != 0) {
+				logInternal(ZLOG_WARNING, "Failed to set worker affinity to CPU " + std::to_string(cpu) + " (errno " + std::to_string(ret) + ")",
+					__FILE__, __FUNCTION__, __LINE__);
+			}
+		}
+
+		pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+		if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), priority) != 0) {
+			logInternal(ZLOG_WARNING, "Failed to set worker priority to " + std::to_string(priority) + " (errno " + std::to_string(errno) + ")",
+				__FILE__, __FUNCTION__, __LINE__);
+		}
+#endif
+	}
+
+	void ZLogging::wakeWorker() {
+		if (workerClient_) {
+			workerPool_->schedule(workerClient_);
+		}
+		else {
+			queueCondition_.notify_one();
+		}
+	}
+
+	void ZLogging::syncLogFiles(ZLogDurability minMode) {
+		std::lock_guard<std::mutex> fileLock(fileMutex_);
+
+		auto syncWriter = [this, minMode](std::unique_ptr<ZLogFileWriter>& writer) {
+			if (writer && writer->isOpen() && writer->getUnsyncedMode() >= minMode) {
+				if (writer->sync() != 0) {
+					reportFileError(*writer, "sync");
+				}
+			}
+			};
+
+		syncWriter(singleFileWriter_);
+		for (auto& writer : fileWriters_) {
+			syncWriter(writer);
+		}
+
+		fileCache_.forEach([this, minMode](ZLogFileWriter& writer) {
+			if (writer.getUnsyncedMode() >= minMode && writer.sync() != 0) {
+				reportFileError(writer, "sync");
+			}
+			});
+	}
+
+	void ZLogging::commitDurable(size_t sequence) {
+		bool groupCommit = std::any_of(durability_.begin(), durability_.end(), [](ZLogDurability mode) {
+			return mode == DURABILITY_GROUP_COMMIT;
+			});
+
+		if (groupCommit) {
+			syncLogFiles(DURABILITY_GROUP_COMMIT);
+		}
+
+		{
+			std::lock_guard<std::mutex> durableLock(durableMutex_);
+			if (sequence > durableSequence_.load()) {
+				durableSequence_.store(sequence);
+			}
+		}
+		durableCondition_.notify_all();
+	}
+
+	void ZLogging::waitDurable(size_t sequence) {
+		if (tlsCommitting_ == this) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> durableLock(durableMutex_);
+		durableCondition_.wait(durableLock, [this, sequence] {
+			return durableSequence_.load() >= sequence || stopWorker_.load();
+			});
+	}
+
+	bool ZLogging::waitCommitted(size_t sequence, int timeoutMs) {
+		std::unique_lock<std::mutex> durableLock(durableMutex_);
+		if (durableSequence_.load() >= sequence) {
+			return true;
+		}
+		durableLock.unlock();
+
+		wakeWorker();
+
+		durableLock.lock();
+		auto committed = [this, sequence] {
+			return durableSequence_.load() >= sequence || stopWorker_.load();
+			};
+
+		if (timeoutMs < 0) {
+			durableCondition_.wait(durableLock, committed);
+		}
+		else {
+			durableCondition_.wait_for(durableLock, std::chrono::milliseconds(timeoutMs), committed);
+		}
+		return durableSequence_.load() >= sequence;
+	}
+
+	bool ZLogging::hasPeriodicSync() const {
+		return std::any_of(durability_.begin(), durability_.end(), [](ZLogDurability mode) {
+			return mode == DURABILITY_PERIODIC;
+			});
+	}
+
+	void ZLogging::processLogEntry(const ZLogEntry& entry, const std::string* plain) {
+		if (outputMode_ & CONSOLE_OUT) {
+			writeToConsole(entry, plain);
+		}
+
+		if (outputMode_ & FILE_OUT) {
+			writeToFile(entry, plain);
+		}
+
+		if (outputMode_ & SYSLOG_OUT) {
+			writeToSyslog(entry);
+		}
+
+		if (outputMode_ & TCP_OUT) {
+			writeToTcp(entry, plain);
+		}
+
+		if (outputMode_ & SHM_OUT) {
+			writeToShm(entry, plain);
+		}
+
+		if (outputMode_ & MEMORY_OUT) {
+			writeToMemory(entry, plain);
+		}
+	}
+
+	void ZLogging::renderBatch(const std::vector<ZLogEntry>& batch) {
+		if (renderedBatch_.size() < batch.size()) {
+			renderedBatch_.resize(batch.size());
+		}
+
+		formatPool_.run(batch.size(), DEFAULT_FORMAT_CHUNK_SIZE, [this, &batch](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				formatLogEntry(batch[i], false, renderedBatch_[i]);
+			}
+			});
+	}
+
+	void ZLogging::renderPlainEntry(const ZLogEntry& entry, const std::string* plain, std::string& output) const {
+		if (plain) {
+			output.assign(*plain);
+		}
+		else {
+			formatLogEntry(entry, false, output);
+		}
+	}
+
+	void ZLogging::flushSinks() {
+		{
+			std::lock_guard<std::mutex> consoleLock(consoleMutex_);
+			consoleSink_.flush();
+		}
+
+		{
+			std::lock_guard<std::mutex> syslogLock(syslogMutex_);
+			syslogSink_.flush();
+		}
+
+		{
+			std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+			tcpSink_.flush();
+		}
+
+		{
+			std::lock_guard<std::mutex> shmLock(shmMutex_);
+			shmSink_.flush();
+		}
+	}
+
+	void ZLogging::flushFileWriters() {
+		std::lock_guard<std::mutex> fileLock(fileMutex_);
+		if (fileMode_ == ALWAYS_OPEN) {
+			if (singleFileOutput_ && singleFileWriter_ && singleFileWriter_->isOpen()) {
+				if (singleFileWriter_->flush() != 0) {
+					reportFileError(*singleFileWriter_, "flush");
+				}
+			}
+			else {
+				for (auto& writer : fileWriters_) {
+					if (writer && writer->isOpen() && writer->flush() != 0) {
+						reportFileError(*writer, "flush");
+					}
+				}
+			}
+		}
+		else {
+			fileCache_.forEach([this](ZLogFileWriter& writer) {
+				if (writer.flush() != 0) {
+					reportFileError(writer, "flush");
+				}
+				});
+		}
 	}
 
-	size_t ZLogging::getMaxCacheSize() const {
-		std::lock_guard<std::mutex> lock(configMutex_);
-		return maxCacheSize_;
-	}
+	int ZLogging::getWorkerWaitTimeout() const {
+		int timeoutMs = hasPeriodicSync() ? syncIntervalMs_ : 0;
 
-	size_t ZLogging::getQueueSize() const {
-		std::lock_guard<std::mutex> lock(queueMutex_);
-		return messageQueue_.size();
-	}
+		if (outputMode_ & TCP_OUT) {
+			std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+			if (tcpSink_.isOpen() && (tcpSink_.hasBacklog() || !tcpSink_.isConnected())) {
+				timeoutMs = (timeoutMs > 0) ? std::min(timeoutMs, DEFAULT_TCP_RETRY_MIN_MS) : DEFAULT_TCP_RETRY_MIN_MS;
+			}
+		}
 
-	size_t ZLogging::getTotalLogCount() const {
-		return totalLogCount_.load();
-	}
+		if (fileMode_ == OPEN_ON_WRITE) {
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
+			if (fileCache_.getOpenCount() > 0) {
+				int idleMs = std::max(fileCache_.getIdleTimeout(), 1);
+				timeoutMs = (timeoutMs > 0) ? std::min(timeoutMs, idleMs) : idleMs;
+			}
+		}
 
-	size_t ZLogging::getLogCount(ZLogLevel level) const {
-		auto it = levelLogCounts_.find(level);
-		return (it != levelLogCounts_.end()) ? it->second.load() : 0;
+		if (!metricsPath_.empty()) {
+			timeoutMs = (timeoutMs > 0) ? std::min(timeoutMs, metricsIntervalMs_) : metricsIntervalMs_;
+		}
+
+		if (hasSuppressionSites_.load()) {
+			timeoutMs = (timeoutMs > 0) ? std::min(timeoutMs, DEFAULT_SUPPRESSION_CHECK_MS) : DEFAULT_SUPPRESSION_CHECK_MS;
+		}
+
+		return timeoutMs;
 	}
 
-	size_t ZLogging::getDroppedMessageCount() const {
-		return droppedMessageCount_.load();
+	void ZLogging::writeToConsole(const ZLogEntry& entry, const std::string* plain) {
+		ZLogConsoleStream stream = (entry.level >= ZLOG_ERROR) ? CONSOLE_STDERR : CONSOLE_STDOUT;
+		if (useConsoleColor(stream)) {
+			formatLogEntry(entry, true, tlsFormatBuffer_);
+		}
+		else {
+			renderPlainEntry(entry, plain, tlsFormatBuffer_);
+		}
+		tlsFormatBuffer_ += '\n';
+
+		std::lock_guard<std::mutex> consoleLock(consoleMutex_);
+		consoleSink_.write(stream, tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
 	}
 
-	void ZLogging::runAsyncWorker() {
-		while (!stopWorker_.load()) {
-			std::unique_lock<std::mutex> lock(queueMutex_);
-			queueCondition_.wait(lock, [this] {
-				return !messageQueue_.empty() || stopWorker_.load();
-				});
+	void ZLogging::writeToSyslog(const ZLogEntry& entry) {
+		formatSyslogEntry(entry, tlsFormatBuffer_);
 
-			std::vector<ZLogEntry> batch;
-			batch.reserve(std::min(messageQueue_.size(), size_t(100)));
+		std::lock_guard<std::mutex> syslogLock(syslogMutex_);
+		syslogSink_.write(tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
+	}
 
-			while (!messageQueue_.empty() && batch.size() < 100) {
-				batch.emplace_back(std::move(messageQueue_.front()));
-				messageQueue_.pop_front();
-			}
-			lock.unlock();
+	void ZLogging::openSyslog() {
+		std::lock_guard<std::mutex> syslogLock(syslogMutex_);
+		if (syslogSink_.isOpen()) {
+			return;
+		}
 
-			for (const auto& entry : batch) {
-				processLogEntry(entry);
-			}
+		std::string target = syslogTarget_.empty() ? DEFAULT_SYSLOG_TARGET : syslogTarget_;
+		if (syslogSink_.open(target) != 0 && initialized_.load()) {
+			logInternal(ZLOG_ERROR, "Failed to open syslog target " + target + " (errno " + std::to_string(syslogSink_.getLastError()) + ")",
+				__FILE__, __FUNCTION__, __LINE__);
 		}
+	}
 
-		std::lock_guard<std::mutex> lock(queueMutex_);
-		while (!messageQueue_.empty()) {
-			ZLogEntry entry = std::move(messageQueue_.front());
-			messageQueue_.pop_front();
-			processLogEntry(entry);
+	void ZLogging::writeToTcp(const ZLogEntry& entry, const std::string* plain) {
+		if (tcpFormat_ == TCP_FORMAT_JSON) {
+			formatJsonEntry(entry, tlsFormatBuffer_);
+		}
+		else {
+			renderPlainEntry(entry, plain, tlsFormatBuffer_);
 		}
+
+		std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+		tcpSink_.write(tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
 	}
 
-	void ZLogging::processLogEntry(const ZLogEntry& entry) {
-		if (outputMode_ & CONSOLE_OUT) {
-			writeToConsole(entry);
+	void ZLogging::openTcp() {
+		std::lock_guard<std::mutex> tcpLock(tcpMutex_);
+		if (tcpSink_.isOpen() || tcpTarget_.empty()) {
+			return;
 		}
 
-		if (outputMode_ & FILE_OUT) {
-			writeToFile(entry);
+		std::string spoolDir = spoolDir_.empty() ? outputDir_ + "/" + DEFAULT_SPOOL_DIR : spoolDir_;
+		createDirectoryRecursive(spoolDir);
+
+		if (tcpSink_.open(tcpTarget_, spoolDir, spoolMaxSize_) != 0 && initialized_.load()) {
+			logInternal(ZLOG_ERROR, "Invalid TCP log target: " + tcpTarget_, __FILE__, __FUNCTION__, __LINE__);
 		}
 	}
 
-	void ZLogging::writeToConsole(const ZLogEntry& entry) {
-		bool useColor = (outputMode_ & COLOR_OUT) != 0;
-		formatLogEntry(entry, useColor, tlsFormatBuffer_);
+	void ZLogging::writeToShm(const ZLogEntry& entry, const std::string* plain) {
+		renderPlainEntry(entry, plain, tlsFormatBuffer_);
+
+		std::lock_guard<std::mutex> shmLock(shmMutex_);
+		shmSink_.write(tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
+	}
+
+	void ZLogging::writeToMemory(const ZLogEntry& entry, const std::string* plain) {
+		renderPlainEntry(entry, plain, tlsFormatBuffer_);
 
-		static std::mutex consoleMutex;
-		std::lock_guard<std::mutex> consoleLock(consoleMutex);
+		std::lock_guard<std::mutex> memoryLock(memoryMutex_);
+		memorySink_.write(entry.level, entry.timestamp, tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
+	}
 
-		if (entry.level >= ZLOG_ERROR) {
-			std::cerr << tlsFormatBuffer_ << std::endl;
+	void ZLogging::openMemory() {
+		std::lock_guard<std::mutex> memoryLock(memoryMutex_);
+		if (!memorySink_.isOpen()) {
+			memorySink_.open(memoryMaxRecords_, memoryMaxBytes_);
 		}
-		else {
-			std::cout << tlsFormatBuffer_ << std::endl;
+	}
+
+	void ZLogging::openShm() {
+		std::lock_guard<std::mutex> shmLock(shmMutex_);
+		if (shmSink_.isOpen()) {
+			return;
+		}
+
+		std::string name = shmName_.empty() ? "zlog." + programName_ + "." + std::to_string(GETPID()) : shmName_;
+		if (shmSink_.open(name, shmCapacity_) != 0 && initialized_.load()) {
+			logInternal(ZLOG_ERROR, "Failed to open shared memory ring " + name + " (errno " + std::to_string(shmSink_.getLastError()) + ")",
+				__FILE__, __FUNCTION__, __LINE__);
 		}
 	}
 
-	void ZLogging::writeToFile(const ZLogEntry& entry) {
-		formatLogEntry(entry, false, tlsFormatBuffer_);
+	bool ZLogging::useConsoleColor(ZLogConsoleStream stream) const {
+		if (outputMode_ & COLOR_OUT) {
+			return true;
+		}
+		return (outputMode_ & COLOR_AUTO) && consoleSink_.isTty(stream);
+	}
+
+	void ZLogging::writeToFile(const ZLogEntry& entry, const std::string* plain) {
+		renderPlainEntry(entry, plain, tlsFormatBuffer_);
 
 		switch (fileMode_) {
 		case ALWAYS_OPEN: {
 			std::lock_guard<std::mutex> fileLock(fileMutex_);
 
-			if (singleFileOutput_) {
-				if (singleFileStream_ && singleFileStream_->is_open()) {
-					*singleFileStream_ << tlsFormatBuffer_ << std::endl;
-					if (entry.level >= ZLOG_WARNING) {
-						singleFileStream_->flush();
-					}
+			ZLogFileWriter* writer = getFileWriter(entry.level);
+			if (writer && writer->isOpen()) {
+				tlsFormatBuffer_ += '\n';
+				int ret = writer->write(tlsFormatBuffer_.data(), tlsFormatBuffer_.size());
+				if (ret == 0 && entry.level >= ZLOG_WARNING) {
+					ret = writer->flush();
 				}
-
-				if (shouldRotate(singleFileLevel_)) {
-					rotateFile(singleFileLevel_);
+				if (ret != 0) {
+					reportFileError(*writer, "write");
 				}
+				writer->markUnsynced(durability_[entry.level]);
 			}
-			else {
-				auto it = fileStreams_.find(entry.level);
-				if (it != fileStreams_.end() && it->second && it->second->is_open()) {
-					*it->second << tlsFormatBuffer_ << std::endl;
-					if (entry.level >= ZLOG_WARNING) {
-						it->second->flush();
-					}
-				}
 
-				if (shouldRotate(entry.level)) {
-					rotateFile(entry.level);
-				}
+			ZLogLevel checkLevel = singleFileOutput_ ? singleFileLevel_ : entry.level;
+			if (shouldRotate(checkLevel, writer, entry.timestamp)) {
+				rotateFile(checkLevel);
 			}
 			break;
 		}
 		case OPEN_ON_WRITE: {
-			std::string filePath;
+			std::lock_guard<std::mutex> fileLock(fileMutex_);
 
-			{
-				std::lock_guard<std::mutex> configLock(configMutex_);
-				if (singleFileOutput_) {
-					filePath = singleFilePath_;
-				}
-				else {
-					auto it = filePaths_.find(entry.level);
-					if (it != filePaths_.end()) {
-						filePath = it->second;
-					}
-				}
+			const std::string& filePath = singleFileOutput_ ? singleFilePath_ : filePaths_[entry.level];
+			if (filePath.empty()) {
+				break;
 			}
 
-			if (!filePath.empty()) {
-				size_t pos = filePath.find_last_of("/\\");
-				if (pos != std::string::npos) {
-					std::string dir = filePath.substr(0, pos);
-					if (!pathExists(dir)) {
-						createDirectoryRecursive(dir);
-					}
-				}
+			std::unique_ptr<ZLogFileWriter>& writer = fileCache_.acquire(filePath);
+			if (!writer) {
+				openFileWriter(filePath, writer, 0);
+			}
 
-				std::ofstream file(filePath, std::ios::app);
-				if (file.is_open()) {
-					file << tlsFormatBuffer_ << std::endl;
-					if (entry.level >= ZLOG_WARNING) {
-						file.flush();
-					}
+			if (writer) {
+				tlsFormatBuffer_ += '\n';
+				if (writer->write(tlsFormatBuffer_.data(), tlsFormatBuffer_.size()) != 0) {
+					reportFileError(*writer, "write");
 				}
+				writer->markUnsynced(durability_[entry.level]);
+			}
 
-				ZLogLevel checkLevel = singleFileOutput_ ? singleFileLevel_ : entry.level;
-				if (shouldRotate(checkLevel)) {
-					std::lock_guard<std::mutex> fileLock(fileMutex_);
-					if (shouldRotate(checkLevel)) {
-						rotateFile(checkLevel);
-					}
-				}
+			ZLogLevel checkLevel = singleFileOutput_ ? singleFileLevel_ : entry.level;
+			if (shouldRotate(checkLevel, writer.get(), entry.timestamp)) {
+				rotateFile(checkLevel);
 			}
+
+			fileCache_.trim();
 			break;
 		}
 		}
@@ -745,6 +2311,113 @@ namespace zlog {
 		}
 	}
 
+	void ZLogging::formatSyslogEntry(const ZLogEntry& entry, std::string& output) const {
+		output.clear();
+		output.reserve(512);
+
+		auto time_t = std::chrono::system_clock::to_time_t(entry.timestamp);
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(entry.timestamp.time_since_epoch()).count() % 1000;
+
+		char header[64];
+		struct tm tm_buf;
+#ifdef _WIN32
+		bool valid = gmtime_s(&tm_buf, &time_t) == 0;
+#else
+		bool valid = gmtime_r(&time_t, &tm_buf) != nullptr;
+#endif
+
+		ZLOG_SNPRINTF(header, sizeof(header), "<%d>1 ", syslogFacility_ * 8 + getSyslogSeverity(entry.level));
+		output += header;
+
+		if (valid) {
+			ZLOG_SNPRINTF(header, sizeof(header), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ ",
+				tm_buf.tm_year + 1900, tm_buf.tm_mon + 1, tm_buf.tm_mday,
+				tm_buf.tm_hour, tm_buf.tm_min, tm_buf.tm_sec, static_cast<int>(ms));
+			output += header;
+		}
+		else {
+			output += "- ";
+		}
+
+		appendSyslogName(hostName_, 255, output);
+		output += " ";
+		appendSyslogName(programName_, 48, output);
+		output += " ";
+		output += std::to_string(GETPID());
+		output += " ";
+		output += getLevelName(entry.level);
+
+		extractFilename(entry.filePath, tlsFilenameBuffer_);
+		output += " [zlog@32473 file=\"";
+		for (char c : tlsFilenameBuffer_) {
+			if (c == '"' || c == '\\' || c == ']') {
+				output += '\\';
+			}
+			output += c;
+		}
+		output += "\" line=\"";
+		output += std::to_string(entry.lineNumber);
+		output += "\" seq=\"";
+		output += std::to_string(entry.sequence);
+		output += "\"] ";
+		output += entry.message;
+	}
+
+	void ZLogging::formatJsonEntry(const ZLogEntry& entry, std::string& output) const {
+		output.clear();
+		output.reserve(512);
+
+		formatTimestamp(entry.timestamp, tlsTimestampBuffer_);
+		output += "{\"time\":\"";
+		output += tlsTimestampBuffer_;
+		output += "\",\"level\":\"";
+		output += getLevelName(entry.level);
+		output += "\",\"program\":";
+		appendJsonEscaped(programName_, output);
+
+		std::ostringstream tid_oss;
+		tid_oss << entry.threadId;
+		output += ",\"thread\":\"";
+		output += tid_oss.str();
+		output += "\",\"file\":";
+
+		extractFilename(entry.filePath, tlsFilenameBuffer_);
+		appendJsonEscaped(tlsFilenameBuffer_, output);
+		output += ",\"line\":";
+		output += std::to_string(entry.lineNumber);
+		output += ",\"function\":";
+		appendJsonEscaped(entry.functionName, output);
+		output += ",\"seq\":";
+		output += std::to_string(entry.sequence);
+		output += ",\"message\":";
+		appendJsonEscaped(entry.message, output);
+		output += "}";
+	}
+
+	void ZLogging::appendJsonEscaped(const std::string& value, std::string& output) const {
+		output += '"';
+		for (char c : value) {
+			switch (c) {
+			case '"':  output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\n': output += "\\n"; break;
+			case '\r': output += "\\r"; break;
+			case '\t': output += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					ZLOG_SNPRINTF(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+					output += escaped;
+				}
+				else {
+					output += c;
+				}
+				break;
+			}
+		}
+		output += '"';
+	}
+
 	void ZLogging::extractFilename(const std::string& filePath, std::string& output) const {
 		size_t pos = filePath.find_last_of("/\\");
 		if (pos != std::string::npos) {
@@ -793,9 +2466,10 @@ namespace zlog {
 		output += std::to_string(ms.count());
 	}
 
-	std::string ZLogging::generateRotatedFileName(const std::string& originalPath) const {
+	std::string ZLogging::generateRotatedFileName(const std::string& originalPath) {
 		auto now = std::chrono::system_clock::now();
 		auto time_t = std::chrono::system_clock::to_time_t(now);
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
 
 		char timeStr[32];
 
@@ -817,12 +2491,40 @@ namespace zlog {
 		}
 #endif
 
+		char msStr[8];
+		ZLOG_SNPRINTF(msStr, sizeof(msStr), "_%03d", static_cast<int>(ms.count()));
+		std::string stamp = std::string(timeStr) + msStr;
+
+		size_t sepPos = originalPath.find_last_of("/\\");
 		size_t dotPos = originalPath.find_last_of('.');
-		if (dotPos != std::string::npos) {
-			return originalPath.substr(0, dotPos) + "_" + timeStr + originalPath.substr(dotPos);
+		if (dotPos != std::string::npos && sepPos != std::string::npos && dotPos < sepPos) {
+			dotPos = std::string::npos;
+		}
+
+		std::string base = (dotPos != std::string::npos) ? originalPath.substr(0, dotPos) : originalPath;
+		std::string ext = (dotPos != std::string::npos) ? originalPath.substr(dotPos) : "";
+
+		auto& last = rotateStamps_[base];
+		if (last.first == stamp) {
+			++last.second;
 		}
 		else {
-			return originalPath + "_" + timeStr;
+			last.first = stamp;
+			last.second = 0;
+		}
+
+		while (true) {
+			std::string name = base + "_" + stamp;
+			if (last.second > 0) {
+				name += "_" + std::to_string(last.second);
+			}
+			name += ext;
+
+			if (!pathExists(name) && !pathExists(name + ZLogCompressor::getSuffix(COMPRESS_GZIP)) &&
+				!pathExists(name + ZLogCompressor::getSuffix(COMPRESS_ZSTD))) {
+				return name;
+			}
+			++last.second;
 		}
 	}
 
@@ -834,22 +2536,22 @@ namespace zlog {
 			"/";
 #endif
 
-		if (filePaths_.find(ZLOG_TRACE) == filePaths_.end()) {
+		if (filePaths_[ZLOG_TRACE].empty()) {
 			filePaths_[ZLOG_TRACE] = outputDir_ + sep + DEFAULT_TRACE_FILE;
 		}
-		if (filePaths_.find(ZLOG_DEBUG) == filePaths_.end()) {
+		if (filePaths_[ZLOG_DEBUG].empty()) {
 			filePaths_[ZLOG_DEBUG] = outputDir_ + sep + DEFAULT_DEBUG_FILE;
 		}
-		if (filePaths_.find(ZLOG_INFO) == filePaths_.end()) {
+		if (filePaths_[ZLOG_INFO].empty()) {
 			filePaths_[ZLOG_INFO] = outputDir_ + sep + DEFAULT_INFO_FILE;
 		}
-		if (filePaths_.find(ZLOG_WARNING) == filePaths_.end()) {
+		if (filePaths_[ZLOG_WARNING].empty()) {
 			filePaths_[ZLOG_WARNING] = outputDir_ + sep + DEFAULT_WARNING_FILE;
 		}
-		if (filePaths_.find(ZLOG_ERROR) == filePaths_.end()) {
+		if (filePaths_[ZLOG_ERROR].empty()) {
 			filePaths_[ZLOG_ERROR] = outputDir_ + sep + DEFAULT_ERROR_FILE;
 		}
-		if (filePaths_.find(ZLOG_FATAL) == filePaths_.end()) {
+		if (filePaths_[ZLOG_FATAL].empty()) {
 			filePaths_[ZLOG_FATAL] = outputDir_ + sep + DEFAULT_FATAL_FILE;
 		}
 	}
@@ -876,7 +2578,7 @@ namespace zlog {
 		int ret = MKDIR(path.c_str());
 		if (ret != 0 && !pathExists(path)) {
 			if (initialized_.load()) {
-				logDirect(ZLOG_ERROR, "Failed to create directory: " + path, __FILE__, __FUNCTION__, __LINE__);
+				logInternal(ZLOG_ERROR, "Failed to create directory: " + path, __FILE__, __FUNCTION__, __LINE__);
 			}
 		}
 	}
@@ -896,118 +2598,115 @@ namespace zlog {
 	void ZLogging::openLogFiles() {
 		if (singleFileOutput_) {
 			if (!singleFilePath_.empty()) {
-				size_t pos = singleFilePath_.find_last_of("/\\");
-				if (pos != std::string::npos) {
-					std::string dir = singleFilePath_.substr(0, pos);
-					if (!pathExists(dir)) {
-						createDirectoryRecursive(dir);
-					}
+				openFileWriter(singleFilePath_, singleFileWriter_);
+			}
+		}
+		else {
+			for (size_t i = 0; i < ZLOG_LEVEL_COUNT; ++i) {
+				if (!filePaths_[i].empty()) {
+					openFileWriter(filePaths_[i], fileWriters_[i]);
 				}
+			}
+		}
+	}
 
-				if (singleFileStream_) {
-					singleFileStream_->close();
-				}
+	void ZLogging::closeLogFiles() {
+		if (singleFileWriter_ && singleFileWriter_->close() != 0) {
+			reportFileError(*singleFileWriter_, "close");
+		}
+		singleFileWriter_.reset();
 
-				singleFileStream_ = std::make_shared<std::ofstream>(singleFilePath_, std::ios::app);
-				if (singleFileStream_->is_open()) {
-					singleFileStream_->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-				}
-				else {
-					singleFileStream_.reset();
-				}
+		for (auto& writer : fileWriters_) {
+			if (writer && writer->close() != 0) {
+				reportFileError(*writer, "close");
 			}
+			writer.reset();
 		}
-		else {
-			for (const auto& pair : filePaths_) {
-				ZLogLevel level = pair.first;
-				const std::string& filepath = pair.second;
-
-				size_t pos = filepath.find_last_of("/\\");
-				if (pos != std::string::npos) {
-					std::string dir = filepath.substr(0, pos);
-					if (!pathExists(dir)) {
-						createDirectoryRecursive(dir);
-					}
-				}
 
-				if (fileStreams_[level]) {
-					fileStreams_[level]->close();
-				}
+		fileCache_.closeAll();
+	}
 
-				fileStreams_[level] = std::make_shared<std::ofstream>(filepath, std::ios::app);
-				if (fileStreams_[level]->is_open()) {
-					fileStreams_[level]->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-				}
-				else {
-					fileStreams_[level].reset();
-				}
+	void ZLogging::closeIdleFiles() {
+		std::lock_guard<std::mutex> fileLock(fileMutex_);
+		fileCache_.closeIdle();
+	}
+
+	void ZLogging::openFileWriter(const std::string& filePath, std::unique_ptr<ZLogFileWriter>& writer) {
+		openFileWriter(filePath, writer, maxBufferSize_);
+	}
+
+	void ZLogging::openFileWriter(const std::string& filePath, std::unique_ptr<ZLogFileWriter>& writer, size_t bufferSize) {
+		size_t pos = filePath.find_last_of("/\\");
+		if (pos != std::string::npos) {
+			std::string dir = filePath.substr(0, pos);
+			if (!pathExists(dir)) {
+				createDirectoryRecursive(dir);
 			}
 		}
+
+		if (!writer) {
+			writer.reset(new ZLogFileWriter());
+		}
+
+		writer->setPreallocateSize(preallocateSize_);
+		writer->setCompression(streamCompression_);
+		if (writer->open(filePath, bufferSize) != 0) {
+			reportFileError(*writer, "open");
+			writer.reset();
+		}
 	}
 
-	void ZLogging::closeLogFiles() {
-		if (singleFileStream_ && singleFileStream_->is_open()) {
-			singleFileStream_->close();
+	void ZLogging::reportFileError(ZLogFileWriter& writer, const std::string& action) {
+		if (initialized_.load() && writer.shouldReportError()) {
+			logInternal(ZLOG_ERROR, "Failed to " + action + " log file " + writer.getPath() + ": " + writer.getLastErrorString(),
+				__FILE__, __FUNCTION__, __LINE__);
 		}
-		singleFileStream_.reset();
+	}
 
-		for (auto& stream : fileStreams_) {
-			if (stream.second && stream.second->is_open()) {
-				stream.second->close();
-			}
+	ZLogFileWriter* ZLogging::getFileWriter(ZLogLevel level) const {
+		if (singleFileOutput_) {
+			return singleFileWriter_.get();
 		}
-		fileStreams_.clear();
+		if (level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return nullptr;
+		}
+		return fileWriters_[level].get();
 	}
 
-	bool ZLogging::shouldRotate(ZLogLevel level) const {
+	bool ZLogging::shouldRotate(ZLogLevel level, ZLogFileWriter* writer, std::chrono::system_clock::time_point now) {
 		if (rotatePolicy_ == NO_ROTATE) {
 			return false;
 		}
 
-		std::string filePath;
-		if (singleFileOutput_) {
-			filePath = singleFilePath_;
+		if (!singleFileOutput_ && (level < ZLOG_TRACE || level > ZLOG_FATAL)) {
+			return false;
 		}
-		else {
-			auto it = filePaths_.find(level);
-			if (it == filePaths_.end()) {
-				return false;
-			}
-			filePath = it->second;
+		const std::string& filePath = singleFileOutput_ ? singleFilePath_ : filePaths_[level];
+		if (filePath.empty()) {
+			return false;
 		}
 
 		switch (rotatePolicy_) {
-		case SIZE_ROTATE:
-			return getFileSize(filePath) >= maxLogSize_;
-
-		case TIME_ROTATE:
-		case DAILY_ROTATE: {
-			auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-			auto lastRotate = lastRotateTime_.load();
-
-			if (lastRotate == 0) {
-				lastRotateTime_.store(now);
-				return false;
+		case SIZE_ROTATE: {
+			if (writer == nullptr) {
+				return getFileSize(filePath) >= maxLogSize_;
 			}
 
-#ifdef _WIN32
-			struct tm nowTm, lastTm;
-			if (localtime_s(&nowTm, &now) != 0 || localtime_s(&lastTm, &lastRotate) != 0) {
-				return false;
-			}
-#else
-			struct tm nowTm, lastTm;
-			if (localtime_r(&now, &nowTm) == nullptr || localtime_r(&lastRotate, &lastTm) == nullptr) {
-				return false;
+			if (writer->isOpen()) {
+				writer->refreshFileSize(DEFAULT_SIZE_SYNC_INTERVAL_MS);
 			}
-#endif
+			return writer->getFileSize() >= maxLogSize_;
+		}
 
-			if (nowTm.tm_mday != lastTm.tm_mday ||
-				nowTm.tm_mon != lastTm.tm_mon ||
-				nowTm.tm_year != lastTm.tm_year) {
-				return true;
+		case TIME_ROTATE:
+		case DAILY_ROTATE: {
+			std::atomic<int64_t>& boundary = getRotateBoundary(level);
+			int64_t next = boundary.load(std::memory_order_relaxed);
+			if (next == 0) {
+				boundary.store(computeRotateBoundary(now), std::memory_order_relaxed);
+				return false;
 			}
-			return false;
+			return now.time_since_epoch().count() >= next;
 		}
 
 		default:
@@ -1016,115 +2715,140 @@ namespace zlog {
 	}
 
 	void ZLogging::rotateFile(ZLogLevel level) {
-		std::string filePath;
-		std::shared_ptr<std::ofstream> stream;
+		if (!singleFileOutput_ && (level < ZLOG_TRACE || level > ZLOG_FATAL)) {
+			return;
+		}
 
-		if (singleFileOutput_) {
-			filePath = singleFilePath_;
-			stream = singleFileStream_;
+		std::string filePath = singleFileOutput_ ? singleFilePath_ : filePaths_[level];
+		std::unique_ptr<ZLogFileWriter>& writer = singleFileOutput_ ? singleFileWriter_ : fileWriters_[level];
+		if (filePath.empty()) {
+			return;
 		}
-		else {
-			auto pathIt = filePaths_.find(level);
-			if (pathIt == filePaths_.end()) {
+
+		auto now = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point& retryTime = getRotateRetryTime(level);
+		if (now < retryTime) {
+			return;
+		}
+
+		auto advanceBoundary = [this, level]() {
+			if (rotatePolicy_ == TIME_ROTATE || rotatePolicy_ == DAILY_ROTATE) {
+				getRotateBoundary(level).store(computeRotateBoundary(std::chrono::system_clock::now()), std::memory_order_relaxed);
+			}
+			};
+
+		ZLogRotateTask task;
+		task.filePath = filePath;
+		task.compression = (streamCompression_ == COMPRESS_NONE) ? rotateCompression_ : COMPRESS_NONE;
+		task.managedPaths = getManagedFilePaths();
+
+		std::unique_ptr<ZLogFileWriter>* active = (fileMode_ == ALWAYS_OPEN) ? &writer : fileCache_.find(filePath);
+		if (active && *active && (*active)->isOpen()) {
+			std::string freshPath;
+			do {
+				freshPath = filePath + "." + std::to_string(++freshFileCounter_) + ZLOG_FRESH_FILE_SUFFIX;
+			} while (pathExists(freshPath));
+
+			std::unique_ptr<ZLogFileWriter> fresh;
+			openFileWriter(freshPath, fresh, (fileMode_ == ALWAYS_OPEN) ? maxBufferSize_ : 0);
+			if (!fresh) {
+				retryTime = now + std::chrono::milliseconds(DEFAULT_ROTATE_RETRY_MS);
+				advanceBoundary();
 				return;
 			}
-			filePath = pathIt->second;
 
-			auto streamIt = fileStreams_.find(level);
-			if (streamIt != fileStreams_.end()) {
-				stream = streamIt->second;
-			}
+			task.freshPath = freshPath;
+			task.oldWriter = std::move(*active);
+			*active = std::move(fresh);
+		}
+		else if (rotator_.isPending(filePath)) {
+			return;
 		}
+		else {
+			retryTime = now + std::chrono::milliseconds(DEFAULT_ROTATE_RETRY_MS);
+		}
+
+		task.rotatedPath = generateRotatedFileName(filePath);
+		rotator_.enqueue(std::move(task));
+		advanceBoundary();
+	}
 
-		if (stream && stream->is_open()) {
-			stream->flush();
-			stream->close();
+	std::atomic<int64_t>& ZLogging::getRotateBoundary(ZLogLevel level) {
+		if (singleFileOutput_ || level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return singleRotateBoundary_;
 		}
+		return rotateBoundaries_[level];
+	}
 
-		std::string newFileName = generateRotatedFileName(filePath);
+	std::chrono::steady_clock::time_point& ZLogging::getRotateRetryTime(ZLogLevel level) {
+		if (singleFileOutput_ || level < ZLOG_TRACE || level > ZLOG_FATAL) {
+			return singleRotateRetryTime_;
+		}
+		return rotateRetryTimes_[level];
+	}
 
-		if (std::rename(filePath.c_str(), newFileName.c_str()) != 0) {
-			try {
-				std::ifstream src(filePath, std::ios::binary);
-				if (!src) {
-					if (initialized_.load()) {
-						logDirect(ZLOG_ERROR, "Failed to open source file for rotation: " + filePath,
-								  __FILE__, __FUNCTION__, __LINE__);
-					}
-				}
-				else {
-					std::ofstream dst(newFileName, std::ios::binary);
-					if (!dst) {
-						if (initialized_.load()) {
-							logDirect(ZLOG_ERROR, "Failed to create rotated file: " + newFileName,
-									  __FILE__, __FUNCTION__, __LINE__);
-						}
-					}
-					else {
-						dst << src.rdbuf();
-
-						if (src.bad() || dst.bad()) {
-							if (initialized_.load()) {
-								logDirect(ZLOG_ERROR, "Error occurred during file rotation copy",
-									__FILE__, __FUNCTION__, __LINE__);
-							}
-						}
-						else {
-							src.close();
-							dst.close();
-
-							std::ofstream clear(filePath, std::ios::trunc);
-							if (!clear) {
-								if (initialized_.load()) {
-									logDirect(ZLOG_ERROR, "Failed to truncate original file after rotation: " + filePath,
-										__FILE__, __FUNCTION__, __LINE__);
-								}
-							}
-							clear.close();
-						}
-					}
-				}
+	int64_t ZLogging::computeRotateBoundary(std::chrono::system_clock::time_point now) const {
+		std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
+		int interval = (rotatePolicy_ == DAILY_ROTATE) ? ZLOG_SECONDS_PER_DAY : rotateInterval_;
+		std::time_t next;
+
+		struct tm tm_buf;
+#ifdef _WIN32
+		bool ok = (localtime_s(&tm_buf, &nowTime) == 0);
+#else
+		bool ok = (localtime_r(&nowTime, &tm_buf) != nullptr);
+#endif
+
+		if (!ok || interval > ZLOG_SECONDS_PER_DAY) {
+			next = nowTime + interval;
+		}
+		else if (interval == ZLOG_SECONDS_PER_DAY) {
+			tm_buf.tm_hour = rotateOffset_ / 3600;
+			tm_buf.tm_min = (rotateOffset_ / 60) % 60;
+			tm_buf.tm_sec = rotateOffset_ % 60;
+			tm_buf.tm_isdst = -1;
+			next = std::mktime(&tm_buf);
+			if (next <= nowTime) {
+				tm_buf.tm_mday += 1;
+				tm_buf.tm_isdst = -1;
+				next = std::mktime(&tm_buf);
 			}
-			catch (const std::exception& e) {
-				if (initialized_.load()) {
-					logDirect(ZLOG_ERROR, "Exception during file rotation: " + std::string(e.what()),
-						__FILE__, __FUNCTION__, __LINE__);
-				}
+		}
+		else {
+			tm_buf.tm_hour = 0;
+			tm_buf.tm_min = 0;
+			tm_buf.tm_sec = 0;
+			tm_buf.tm_isdst = -1;
+			std::time_t base = std::mktime(&tm_buf) + rotateOffset_ % interval;
+			if (base > nowTime) {
+				base -= interval;
 			}
+			next = base + ((nowTime - base) / interval + 1) * interval;
 		}
 
-		if (fileMode_ == ALWAYS_OPEN) {
-			try {
-				stream = std::make_shared<std::ofstream>(filePath, std::ios::app);
-				if (stream && stream->is_open()) {
-					stream->rdbuf()->pubsetbuf(nullptr, maxBufferSize_);
-				}
-				else {
-					if (initialized_.load()) {
-						logDirect(ZLOG_ERROR, "Failed to reopen file after rotation: " + filePath,
-							__FILE__, __FUNCTION__, __LINE__);
-					}
-					stream.reset();
-				}
+		return std::chrono::system_clock::from_time_t(next).time_since_epoch().count();
+	}
 
-				if (singleFileOutput_) {
-					singleFileStream_ = stream;
-				}
-				else {
-					fileStreams_[level] = stream;
-				}
-			}
-			catch (const std::exception& e) {
-				if (initialized_.load()) {
-					logDirect(ZLOG_ERROR, "Exception when reopening file after rotation: " + std::string(e.what()),
-						__FILE__, __FUNCTION__, __LINE__);
-				}
-			}
+	void ZLogging::resetRotateBoundaries() {
+		for (auto& boundary : rotateBoundaries_) {
+			boundary.store(0, std::memory_order_relaxed);
+		}
+		singleRotateBoundary_.store(0, std::memory_order_relaxed);
+	}
+
+	std::vector<std::string> ZLogging::getManagedFilePaths() const {
+		std::vector<std::string> paths;
+		if (singleFileOutput_) {
+			paths.push_back(singleFilePath_);
+			return paths;
 		}
 
-		if (rotatePolicy_ == TIME_ROTATE || rotatePolicy_ == DAILY_ROTATE) {
-			lastRotateTime_.store(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+		for (const auto& path : filePaths_) {
+			if (!path.empty() && std::find(paths.begin(), paths.end(), path) == paths.end()) {
+				paths.push_back(path);
+			}
 		}
+		return paths;
 	}
 
 } // namespace zlog
\ No newline at end of file
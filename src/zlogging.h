@@ -26,8 +26,21 @@
 #include <atomic>
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <vector>
 #include <future>
+#include <array>
+
+#include "zlogfile.h"
+#include "zlogsink.h"
+#include "zlogshm.h"
+#include "zlogmemory.h"
+#include "zlogmetrics.h"
+#include "zlogsites.h"
+#include "zlogrotate.h"
+#include "zlogcrash.h"
+#include "zlogpool.h"
+#include "zloglimit.h"
 
 namespace zlog {
 
@@ -47,6 +60,19 @@ namespace zlog {
 	static const size_t DEFAULT_MAX_CACHE_SIZE   = 1000;
 	static const size_t DEFAULT_MAX_BUFFER_SIZE  = 10 * 1024;
 	static const size_t DEFAULT_MAX_MESSAGE_SIZE = 4 * 1024;
+	static const size_t DEFAULT_PREALLOCATE_SIZE = 0;
+	static const int    DEFAULT_SYNC_INTERVAL_MS = 1000;
+	static const int    DEFAULT_SIZE_SYNC_INTERVAL_MS = 1000;
+	static const int    DEFAULT_ROTATE_INTERVAL  = 3600;
+	static const int    DEFAULT_ROTATE_RETRY_MS  = 1000;
+	static const int    DEFAULT_SUPPRESSION_CHECK_MS = 1000;
+	static const int    DEFAULT_WORKER_SPIN_US   = 0;
+	static const int    MAX_WORKER_SPIN_US       = 1000 * 1000;
+	static const int    DEFAULT_FLUSH_TIMEOUT_MS = 1000;
+	static const int    DEFAULT_SHUTDOWN_TIMEOUT_MS = 3000;
+	static const size_t MAX_BACKTRACE_CAPACITY   = 1024 * 1024;
+	static const double DEFAULT_QUEUE_MEMORY_FRACTION = 0.05;
+	static const int    ZLOG_SECONDS_PER_DAY     = 24 * 3600;
 
 	enum ZLogLevel {
 		ZLOG_TRACE,
@@ -69,10 +95,17 @@ namespace zlog {
 #endif
 	};
 
+	static const size_t ZLOG_LEVEL_COUNT = ZLOG_FATAL + 1;
+
 	enum ZLogOutputMode {
 		CONSOLE_OUT = 1 << 0,
 		FILE_OUT    = 1 << 2,
-		COLOR_OUT   = 1 << 3
+		COLOR_OUT   = 1 << 3,
+		COLOR_AUTO  = 1 << 4,
+		SYSLOG_OUT  = 1 << 5,
+		TCP_OUT     = 1 << 6,
+		SHM_OUT     = 1 << 7,
+		MEMORY_OUT  = 1 << 8
 	};
 
 	enum ZLogFileMode {
@@ -87,6 +120,12 @@ namespace zlog {
 		DAILY_ROTATE
 	};
 
+	enum ZLogDurability {
+		DURABILITY_NONE,
+		DURABILITY_PERIODIC,
+		DURABILITY_GROUP_COMMIT
+	};
+
 	inline const char* getLevelName(ZLogLevel level) {
 		switch (level) {
 		case ZLOG_TRACE:   return "TRACE";
@@ -115,12 +154,37 @@ namespace zlog {
 		return "\033[0m";
 	}
 
+	inline int getSyslogSeverity(ZLogLevel level) {
+		switch (level) {
+		case ZLOG_TRACE:   return 7;
+		case ZLOG_DEBUG:   return 7;
+		case ZLOG_INFO:    return 6;
+		case ZLOG_WARNING: return 4;
+		case ZLOG_ERROR:   return 3;
+		case ZLOG_FATAL:   return 2;
+		default:           return 5;
+		}
+	}
+
+	inline void appendSyslogName(const std::string& value, size_t maxLength, std::string& output) {
+		size_t length = std::min(value.size(), maxLength);
+		if (length == 0) {
+			output += '-';
+			return;
+		}
+		for (size_t i = 0; i < length; ++i) {
+			unsigned char c = static_cast<unsigned char>(value[i]);
+			output += (c >= 33 && c <= 126) ? static_cast<char>(c) : '-';
+		}
+	}
+
 	struct ZLogEntry {
 		ZLogLevel level;
 		std::string message;
 		std::string filePath;
 		std::string functionName;
 		std::chrono::system_clock::time_point timestamp;
+		std::chrono::steady_clock::time_point enqueueTime;
 		std::thread::id threadId;
 		int lineNumber;
 		size_t sequence;
@@ -141,7 +205,7 @@ namespace zlog {
 
 		ZLogEntry(const ZLogEntry& other)
 			: level(other.level), message(other.message), filePath(other.filePath), functionName(other.functionName)
-			, timestamp(other.timestamp), threadId(other.threadId), lineNumber(other.lineNumber), sequence(other.sequence) {
+			, timestamp(other.timestamp), enqueueTime(other.enqueueTime), threadId(other.threadId), lineNumber(other.lineNumber), sequence(other.sequence) {
 		}
 
 		ZLogEntry& operator=(const ZLogEntry& other) {
@@ -151,6 +215,7 @@ namespace zlog {
 				filePath = other.filePath;
 				functionName = other.functionName;
 				timestamp = other.timestamp;
+				enqueueTime = other.enqueueTime;
 				threadId = other.threadId;
 				lineNumber = other.lineNumber;
 				sequence = other.sequence;
@@ -160,7 +225,7 @@ namespace zlog {
 
 		ZLogEntry(ZLogEntry&& other) noexcept
 			: level(other.level), message(std::move(other.message)), filePath(std::move(other.filePath))
-			, functionName(std::move(other.functionName)), timestamp(other.timestamp)
+			, functionName(std::move(other.functionName)), timestamp(other.timestamp), enqueueTime(other.enqueueTime)
 			, threadId(other.threadId), lineNumber(other.lineNumber), sequence(other.sequence) {
 		}
 
@@ -171,6 +236,7 @@ namespace zlog {
 				filePath = std::move(other.filePath);
 				functionName = std::move(other.functionName);
 				timestamp = other.timestamp;
+				enqueueTime = other.enqueueTime;
 				threadId = other.threadId;
 				lineNumber = other.lineNumber;
 				sequence = other.sequence;
@@ -181,6 +247,23 @@ namespace zlog {
 		~ZLogEntry() = default;
 	};
 
+	struct ZLogBacktraceSlot {
+		std::atomic<bool> busy;
+		uint64_t stamp;
+		ZLogEntry entry;
+
+		ZLogBacktraceSlot() : busy(false), stamp(0) {}
+	};
+
+	struct ZLogSuppressionSite {
+		bool (*takeExpired)(void* site, bool force, uint64_t& suppressed, int64_t& suppressedNs);
+		void* site;
+		ZLogLevel level;
+		std::string filePath;
+		std::string functionName;
+		int line;
+	};
+
 	class ZLogStream;
 	class ZLogScope;
 	class ZLogTimer;
@@ -188,6 +271,7 @@ namespace zlog {
 
 	class ZLogging {
 	public:
+		explicit ZLogging(const std::string& name = "");
 		~ZLogging();
 
 		ZLogging(const ZLogging&) = delete;
@@ -196,6 +280,7 @@ namespace zlog {
 		ZLogging& operator=(ZLogging&&) = delete;
 
 		static ZLogging& getInstance();
+		static ZLogging& getInstance(const std::string& name);
 
 		int initialize();
 
@@ -203,6 +288,8 @@ namespace zlog {
 		int setOutputDirectory(const std::string& dir);
 		int setMaxLogSize(size_t size);
 		int setMaxCacheSize(size_t size);
+		int setMaxQueueBytes(size_t bytes);
+		int setMaxQueueBytesFromCgroup(double fraction = DEFAULT_QUEUE_MEMORY_FRACTION);
 		int setMaxBufferSize(size_t size);
 		int setMinLevel(ZLogLevel level);
 		int setLevelFile(ZLogLevel level, const std::string& fileName);
@@ -210,6 +297,30 @@ namespace zlog {
 		int setOutputMode(int mode, bool singleFile = false, const std::string& filePath = "");
 		int setFileMode(ZLogFileMode mode);
 		int setRotatePolicy(ZLogRotatePolicy policy);
+		int setRotateInterval(int intervalSeconds, int offsetSeconds = 0);
+		int setDurability(ZLogLevel level, ZLogDurability mode, bool waitDurable = false);
+		int setSyncInterval(int intervalMs);
+		int setSynchronous(ZLogLevel level, bool enable);
+		int setFormatThreads(size_t count);
+		int setPreallocateSize(size_t size);
+		int setRotateCompression(ZLogCompression mode);
+		int setStreamCompression(ZLogCompression mode);
+		int setRetention(size_t maxFiles, int maxAgeSeconds = 0, size_t maxTotalBytes = 0);
+		int setFileCache(size_t maxFiles, int idleTimeoutMs = DEFAULT_FILE_IDLE_TIMEOUT_MS);
+		int setConsoleNonBlocking(bool enable, size_t maxBacklog = DEFAULT_CONSOLE_BACKLOG);
+		int setSyslogTarget(const std::string& target, int facility = DEFAULT_SYSLOG_FACILITY);
+		int setTcpTarget(const std::string& target, ZLogTcpFormat format = TCP_FORMAT_TEXT);
+		int setSpoolDirectory(const std::string& dir, size_t maxSize = DEFAULT_SPOOL_MAX_SIZE);
+		int setShmTarget(const std::string& name, size_t capacity = DEFAULT_SHM_CAPACITY);
+		int setMemoryTarget(size_t maxRecords, size_t maxBytes = DEFAULT_MEMORY_MAX_BYTES);
+		int setWorkerPool(ZLogWorkerPool* pool);
+		int setWorkerSpin(int spinUs);
+		int setWorkerAffinity(int cpu);
+		int setWorkerPriority(int priority);
+		int setSampleRate(ZLogLevel level, double rate);
+		int setBacktrace(size_t capacity, ZLogLevel triggerLevel = ZLOG_ERROR);
+		int setMetricsExport(const std::string& path, int intervalMs = DEFAULT_METRICS_INTERVAL_MS);
+		int setSiteStats(bool enable);
 
 		void writeLog(const ZLogEntry& entry);
 		void writeLog(ZLogEntry&& entry);
@@ -217,14 +328,38 @@ namespace zlog {
 		void logDirect(ZLogLevel level, const std::string& msg, const std::string& filePath, const std::string& function, int line = 0);
 		void logDirect(ZLogLevel level, std::string&& msg, const std::string& filePath, const std::string& function, int line = 0);
 
+		template<typename Site>
+		void trackSuppression(Site& site, ZLogLevel level, const std::string& filePath, const std::string& functionName, int line) {
+			if (site.markTracked()) {
+				addSuppressionSite(ZLogSuppressionSite{
+					[](void* p, bool force, uint64_t& suppressed, int64_t& suppressedNs) {
+						return static_cast<Site*>(p)->takeExpired(force, suppressed, suppressedNs);
+					},
+					&site, level, filePath, functionName, line });
+			}
+		}
+		void addSuppressionSite(const ZLogSuppressionSite& site);
+
 		ZLogStream createStream(ZLogLevel level, const std::string& filePath, const std::string& functionName, int line = 0);
 
-		void flush();
-		void shutdown(int timeoutMs = 3000);
+		int flush(int timeoutMs = DEFAULT_FLUSH_TIMEOUT_MS);
+		int shutdown(int timeoutMs = DEFAULT_SHUTDOWN_TIMEOUT_MS);
 		void rotateLogFiles();
+		void dumpBacktrace();
+
+		std::vector<ZLogMemoryRecord> queryMemory(const ZLogMemoryQuery& query = ZLogMemoryQuery()) const;
+		void clearMemory();
+
+		int installCrashHandler(int deadlineMs = DEFAULT_CRASH_DEADLINE_MS);
+		void uninstallCrashHandler();
+		void handleCrash(int signal);
 
 		bool isInitialized() const;
 		bool shouldOutput(ZLogLevel level) const;
+		bool shouldSample(ZLogLevel level);
+		bool recordSample(bool sampled);
+
+		const std::string& getName() const;
 
 		std::string getOutputDirectory() const;
 		std::string getLogFilePath(ZLogLevel level) const;
@@ -234,25 +369,84 @@ namespace zlog {
 
 		ZLogLevel getMinLevel() const;
 		ZLogFileMode getFileMode() const;
+		ZLogDurability getDurability(ZLogLevel level) const;
+		bool isSynchronous(ZLogLevel level) const;
+		double getSampleRate(ZLogLevel level) const;
 
 		size_t getMaxCacheSize() const;
+		size_t getMaxQueueBytes() const;
 		size_t getQueueSize() const;
+		size_t getQueueDepthPeak() const;
+		size_t getQueueBytes() const;
+		size_t getQueueBytesPeak() const;
 		size_t getTotalLogCount() const;
 		size_t getLogCount(ZLogLevel level) const;
 		size_t getDroppedMessageCount() const;
+		size_t getSampledOutCount() const;
+		size_t getConsoleDroppedCount() const;
+		size_t getSyslogSentCount() const;
+		size_t getSyslogDroppedCount() const;
+		size_t getTcpSentCount() const;
+		size_t getTcpSpooledCount() const;
+		size_t getTcpDroppedCount() const;
+		size_t getShmDroppedCount() const;
+		size_t getMemoryRecordCount() const;
+		size_t getMemoryEvictedCount() const;
+
+		ZLogMetrics getMetrics() const;
+		std::string formatMetrics() const;
+		ZLogSiteReport reportTopSites(size_t count);
 
 	private:
-		ZLogging();
-
 		void runAsyncWorker();
-		void processLogEntry(const ZLogEntry& entry);
-		void writeToConsole(const ZLogEntry& entry);
-		void writeToFile(const ZLogEntry& entry);
+		bool runWorkerBatch();
+		bool hasReadyEntries() const;
+		void drainQueue();
+		void wakeWorker();
+		void spinForWork(size_t seenSequence);
+		void applyWorkerTuning();
+		void enqueueLog(ZLogEntry&& entry);
+		size_t enqueueBatch(std::vector<ZLogEntry>&& entries);
+		size_t appendQueued(ZLogEntry&& entry, size_t entryBytes);
+		void logInternal(ZLogLevel level, std::string&& msg, const std::string& filePath, const std::string& function, int line);
+		void recordBacktrace(ZLogEntry&& entry);
+		std::vector<ZLogEntry> takeBacktrace();
+		void reportSuppressed(bool force);
+		void writeLogSync(ZLogEntry&& entry);
+		void processLogEntry(const ZLogEntry& entry, const std::string* plain = nullptr);
+		void renderBatch(const std::vector<ZLogEntry>& batch);
+		void renderPlainEntry(const ZLogEntry& entry, const std::string* plain, std::string& output) const;
+		void writeToConsole(const ZLogEntry& entry, const std::string* plain);
+		void writeToFile(const ZLogEntry& entry, const std::string* plain);
+		void writeToSyslog(const ZLogEntry& entry);
+		void writeToTcp(const ZLogEntry& entry, const std::string* plain);
+		void writeToShm(const ZLogEntry& entry, const std::string* plain);
+		void writeToMemory(const ZLogEntry& entry, const std::string* plain);
+		void flushSinks();
+		void flushFileWriters();
+		void openSyslog();
+		void openTcp();
+		void openShm();
+		void openMemory();
+		int getWorkerWaitTimeout() const;
+		void formatSyslogEntry(const ZLogEntry& entry, std::string& output) const;
+		void formatJsonEntry(const ZLogEntry& entry, std::string& output) const;
+		void appendJsonEscaped(const std::string& value, std::string& output) const;
+		void syncLogFiles(ZLogDurability minMode);
+		void exportMetrics();
+		static size_t getEntryBytes(const ZLogEntry& entry);
+		static size_t getCgroupMemoryLimit();
+		void commitDurable(size_t sequence);
+		void waitDurable(size_t sequence);
+		bool waitCommitted(size_t sequence, int timeoutMs);
+		bool hasPeriodicSync() const;
 		void formatLogEntry(const ZLogEntry& entry, bool useColor, std::string& output) const;
 		void extractFilename(const std::string& filePath, std::string& output) const;
 		void formatTimestamp(const std::chrono::system_clock::time_point timestamp, std::string& output) const;
 
-		std::string generateRotatedFileName(const std::string& originalPath) const;
+		std::string generateRotatedFileName(const std::string& originalPath);
+		std::vector<std::string> getManagedFilePaths() const;
+		ZLogFileWriter* getFileWriter(ZLogLevel level) const;
 
 		void initializeFilePaths();
 
@@ -264,35 +458,97 @@ namespace zlog {
 
 		void openLogFiles();
 		void closeLogFiles();
-
-		bool shouldRotate(ZLogLevel level) const;
+		void openFileWriter(const std::string& filePath, std::unique_ptr<ZLogFileWriter>& writer);
+		void openFileWriter(const std::string& filePath, std::unique_ptr<ZLogFileWriter>& writer, size_t bufferSize);
+		void closeIdleFiles();
+		void reportFileError(ZLogFileWriter& writer, const std::string& action);
+
+		bool useConsoleColor(ZLogConsoleStream stream) const;
+		bool shouldRotate(ZLogLevel level, ZLogFileWriter* writer, std::chrono::system_clock::time_point now);
+		std::atomic<int64_t>& getRotateBoundary(ZLogLevel level);
+		std::chrono::steady_clock::time_point& getRotateRetryTime(ZLogLevel level);
+		int64_t computeRotateBoundary(std::chrono::system_clock::time_point now) const;
+		void resetRotateBoundaries();
 		void rotateFile(ZLogLevel level);
+		void writeCrashLine(ZLogLevel level, const ZLogCrashLine& line, std::array<int, ZLOG_LEVEL_COUNT>& openedFds);
+		void formatCrashLine(const ZLogEntry& entry, ZLogCrashLine& line) const;
+		static void onCrashSignal(int signal);
 
 	private:
 		static std::unique_ptr<ZLogging> instance_;
 		static std::once_flag initFlag_;
+		static std::mutex registryMutex_;
+		static std::map<std::string, std::unique_ptr<ZLogging>> registry_;
+		static std::array<std::atomic<ZLogging*>, MAX_CRASH_LOGGERS> crashLoggers_;
+
+		std::string name_;
 
 		mutable std::mutex configMutex_;
 		mutable std::mutex fileMutex_;
 		mutable std::mutex queueMutex_;
+		std::mutex commitMutex_;
 
 		std::deque<ZLogEntry> messageQueue_;
+		std::deque<size_t> syncBarriers_;
 		std::condition_variable queueCondition_;
 		std::thread asyncWorker_;
+		ZLogWorkerPool* workerPool_;
+		std::shared_ptr<ZLogWorkerPool::Client> workerClient_;
+		bool workerParked_;
+		int workerSpinUs_;
+		int workerAffinity_;
+		int workerPriority_;
+		std::atomic<bool> workerTuneDirty_;
 		std::atomic<bool> stopWorker_;
 		std::atomic<bool> initialized_;
+		std::atomic<bool> workerBusy_;
+		std::atomic<int> crashState_;
+		int crashDeadlineMs_;
+		long crashUtcOffset_;
 
-		std::map<ZLogLevel, std::string> filePaths_;
-		std::map<ZLogLevel, std::shared_ptr<std::ofstream>> fileStreams_;
+		std::array<std::string, ZLOG_LEVEL_COUNT> filePaths_;
+		std::array<std::unique_ptr<ZLogFileWriter>, ZLOG_LEVEL_COUNT> fileWriters_;
 
 		int outputMode_;
 		ZLogFileMode fileMode_;
 		ZLogLevel minLevel_;
 
+		std::unique_ptr<ZLogBacktraceSlot[]> backtraceSlots_;
+		size_t backtraceCapacity_;
+		ZLogLevel backtraceTrigger_;
+		std::atomic<uint64_t> backtraceIndex_;
+		std::atomic<uint64_t> backtraceTaken_;
+
 		bool singleFileOutput_;
 		ZLogLevel singleFileLevel_;
 		std::string singleFilePath_;
-		std::shared_ptr<std::ofstream> singleFileStream_;
+		std::unique_ptr<ZLogFileWriter> singleFileWriter_;
+
+		mutable std::mutex consoleMutex_;
+		ZLogConsoleSink consoleSink_;
+
+		mutable std::mutex syslogMutex_;
+		ZLogSyslogSink syslogSink_;
+		std::string syslogTarget_;
+		int syslogFacility_;
+		std::string hostName_;
+
+		mutable std::mutex tcpMutex_;
+		ZLogTcpSink tcpSink_;
+		std::string tcpTarget_;
+		ZLogTcpFormat tcpFormat_;
+		std::string spoolDir_;
+		size_t spoolMaxSize_;
+
+		mutable std::mutex shmMutex_;
+		ZLogShmWriter shmSink_;
+		std::string shmName_;
+		size_t shmCapacity_;
+
+		std::mutex memoryMutex_;
+		ZLogMemorySink memorySink_;
+		size_t memoryMaxRecords_;
+		size_t memoryMaxBytes_;
 
 		std::string programName_;
 		std::string outputDir_;
@@ -300,23 +556,101 @@ namespace zlog {
 		size_t maxCacheSize_;
 		size_t maxBufferSize_;
 		ZLogRotatePolicy rotatePolicy_;
+		int rotateInterval_;
+		int rotateOffset_;
+		std::array<std::atomic<int64_t>, ZLOG_LEVEL_COUNT> rotateBoundaries_;
+		std::atomic<int64_t> singleRotateBoundary_;
+		std::array<std::chrono::steady_clock::time_point, ZLOG_LEVEL_COUNT> rotateRetryTimes_;
+		std::chrono::steady_clock::time_point singleRotateRetryTime_;
+		size_t preallocateSize_;
+		ZLogCompression rotateCompression_;
+		ZLogCompression streamCompression_;
+		ZLogRotator rotator_;
+		ZLogFileCache fileCache_;
+		ZLogFormatPool formatPool_;
+		std::vector<std::string> renderedBatch_;
+		std::map<std::string, std::pair<std::string, size_t>> rotateStamps_;
+		size_t freshFileCounter_;
+		int syncIntervalMs_;
+		std::array<ZLogDurability, ZLOG_LEVEL_COUNT> durability_;
+		std::array<bool, ZLOG_LEVEL_COUNT> waitDurable_;
+		std::array<bool, ZLOG_LEVEL_COUNT> synchronous_;
+		std::chrono::steady_clock::time_point lastSyncTime_;
+
+		std::mutex durableMutex_;
+		std::condition_variable durableCondition_;
+		std::atomic<size_t> durableSequence_;
 
 		std::atomic<size_t> totalLogCount_;
 		std::atomic<size_t> sequenceCounter_;
 		std::atomic<size_t> droppedMessageCount_;
-		mutable std::atomic<std::time_t> lastRotateTime_;
+		std::atomic<size_t> sampledOutCount_;
+		std::array<std::atomic<uint64_t>, ZLOG_LEVEL_COUNT> sampleThresholds_;
+
+		std::atomic<size_t> queueDepth_;
+		std::atomic<size_t> queueDepthPeak_;
+		size_t maxQueueBytes_;
+		size_t queuedBytes_;
+		std::atomic<size_t> queueBytes_;
+		std::atomic<size_t> queueBytesPeak_;
+		ZLogHistogram queueLatencyHistogram_;
+		ZLogHistogram formatHistogram_;
+		ZLogHistogram writeHistogram_;
+		ZLogHistogram batchSizeHistogram_;
+		std::string metricsPath_;
+		int metricsIntervalMs_;
+		std::chrono::steady_clock::time_point lastMetricsExport_;
+		std::unique_ptr<ZLogSiteTable> siteTable_;
 		std::map<ZLogLevel, std::atomic<size_t>> levelLogCounts_;
 
+		std::mutex suppressionMutex_;
+		std::vector<ZLogSuppressionSite> suppressionSites_;
+		std::atomic<bool> hasSuppressionSites_;
+		std::chrono::steady_clock::time_point lastSuppressionCheck_;
+
 		thread_local static std::string tlsFormatBuffer_;
 		thread_local static std::string tlsTimestampBuffer_;
 		thread_local static std::string tlsFilenameBuffer_;
+		thread_local static ZLogging* tlsCommitting_;
 	};
 
+	inline bool admitRateLimited(ZLogging& logger, ZLogLevel level, ZLogRateLimiter& limiter,
+		const std::string& filePath, const std::string& functionName, int line) {
+		if (!logger.shouldOutput(level)) {
+			return false;
+		}
+
+		uint64_t suppressed = 0;
+		int64_t suppressedNs = 0;
+		if (!limiter.tryAcquire(suppressed, suppressedNs)) {
+			logger.trackSuppression(limiter, level, filePath, functionName, line);
+			return false;
+		}
+		if (suppressed > 0) {
+			logger.logDirect(level, formatSuppressedSummary(suppressed, suppressedNs), filePath, functionName, line);
+		}
+		return true;
+	}
+
+	inline bool admitDedup(ZLogging& logger, ZLogLevel level, ZLogDedup& dedup, const std::string& message,
+		const std::string& filePath, const std::string& functionName, int line) {
+		uint64_t suppressed = 0;
+		int64_t suppressedNs = 0;
+		if (!dedup.admit(message, suppressed, suppressedNs)) {
+			logger.trackSuppression(dedup, level, filePath, functionName, line);
+			return false;
+		}
+		if (suppressed > 0) {
+			logger.logDirect(level, formatSuppressedSummary(suppressed, suppressedNs), filePath, functionName, line);
+		}
+		return true;
+	}
+
 	class ZLogStream {
 	public:
 		ZLogStream(ZLogging* logger, ZLogLevel level, const std::string& filePath, const std::string& functionName, int line = 0)
 			: logger_(logger), level_(level), filePath_(filePath), functionName_(functionName), lineNumber_(line)
-			, isActive_(logger != nullptr && logger->shouldOutput(level)) {
+			, dedup_(nullptr), isActive_(logger != nullptr && logger->shouldOutput(level)) {
 		}
 
 		ZLogStream(const ZLogStream&) = delete;
@@ -329,6 +663,7 @@ namespace zlog {
 			functionName_(std::move(other.functionName_)),
 			lineNumber_(other.lineNumber_),
 			stream_(std::move(other.stream_)),
+			dedup_(other.dedup_),
 			isActive_(other.isActive_) {
 			other.isActive_ = false;
 		}
@@ -342,6 +677,7 @@ namespace zlog {
 				functionName_ = std::move(other.functionName_);
 				lineNumber_ = other.lineNumber_;
 				stream_ = std::move(other.stream_);
+				dedup_ = other.dedup_;
 				isActive_ = other.isActive_;
 				other.isActive_ = false;
 			}
@@ -352,6 +688,11 @@ namespace zlog {
 			flush();
 		}
 
+		ZLogStream& withDedup(ZLogDedup& dedup) {
+			dedup_ = &dedup;
+			return *this;
+		}
+
 		template<typename T>
 		ZLogStream& operator<<(const T& value) {
 			if (isActive_) {
@@ -378,7 +719,8 @@ namespace zlog {
 		void flush() {
 			if (isActive_ && logger_) {
 				std::string message = stream_.str();
-				if (!message.empty()) {
+				if (!message.empty() && (dedup_ == nullptr ||
+					admitDedup(*logger_, level_, *dedup_, message, filePath_, functionName_, lineNumber_))) {
 					ZLogEntry entry(level_, std::move(message), filePath_, functionName_, lineNumber_);
 					logger_->writeLog(std::move(entry));
 				}
@@ -393,6 +735,7 @@ namespace zlog {
 		std::string functionName_;
 		int lineNumber_;
 		std::ostringstream stream_;
+		ZLogDedup* dedup_;
 		bool isActive_;
 	};
 
@@ -445,16 +788,20 @@ namespace zlog {
 		return ZLogging::getInstance();
 	}
 
+	inline ZLogging& getLogger(const std::string& name) {
+		return ZLogging::getInstance(name);
+	}
+
 } // namespace zlog
 
 
 #define ZLOG(level) \
-    (zlog::getLogger().shouldOutput(zlog::level) ? \
+    ((zlog::getLogger().shouldOutput(zlog::level) && zlog::getLogger().shouldSample(zlog::level)) ? \
      zlog::getLogger().createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
      zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
 
 #define ZLOG_IF(level, condition) \
-    (((condition) && zlog::getLogger().shouldOutput(zlog::level)) ? \
+    (((condition) && zlog::getLogger().shouldOutput(zlog::level) && zlog::getLogger().shouldSample(zlog::level)) ? \
      zlog::getLogger().createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
      zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
 
@@ -466,6 +813,30 @@ namespace zlog {
 #define ZERROR()   ZLOG(ERROR)
 #define ZFATAL()   ZLOG(FATAL)
 
+#define ZLOG_TO(logger, level) \
+    (((logger).shouldOutput(zlog::level) && (logger).shouldSample(zlog::level)) ? \
+     (logger).createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
+     zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
+
+#define ZTRACE_TO(logger)   ZLOG_TO(logger, TRACE)
+#define ZDEBUG_TO(logger)   ZLOG_TO(logger, DEBUG)
+#define ZINFO_TO(logger)    ZLOG_TO(logger, INFO)
+#define ZWARNING_TO(logger) ZLOG_TO(logger, WARNING)
+#define ZERROR_TO(logger)   ZLOG_TO(logger, ERROR)
+#define ZFATAL_TO(logger)   ZLOG_TO(logger, FATAL)
+
+#define ZLOG_SAMPLED(level, rate) \
+    ((zlog::getLogger().shouldOutput(zlog::level) && \
+      zlog::getLogger().recordSample(zlog::ZLogSampler::sample(zlog::ZLogSampler::toThreshold(rate)))) ? \
+     zlog::getLogger().createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
+     zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
+
+#define ZLOG_SAMPLED_BY(level, rate, key) \
+    ((zlog::getLogger().shouldOutput(zlog::level) && \
+      zlog::getLogger().recordSample(zlog::ZLogSampler::sampleKey(zlog::ZLogSampler::toThreshold(rate), key))) ? \
+     zlog::getLogger().createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
+     zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
+
 #define ZTRACE_IF(cond)   ZLOG_IF(TRACE, cond)
 #define ZDEBUG_IF(cond)   ZLOG_IF(DEBUG, cond)
 #define ZINFO_IF(cond)    ZLOG_IF(INFO, cond)
@@ -479,13 +850,56 @@ namespace zlog {
 #define ZLOG_SNPRINTF(buffer, size, format, ...) snprintf(buffer, size, format, ##__VA_ARGS__)
 #endif
 
+#define ZLOG_FORMAT_MESSAGE(message, fmt, ...) \
+    thread_local static char buffer[zlog::DEFAULT_MAX_MESSAGE_SIZE]; \
+    int ret = ZLOG_SNPRINTF(buffer, sizeof(buffer), fmt, ##__VA_ARGS__); \
+    if (ret > 0 && ret < static_cast<int>(sizeof(buffer))) { \
+        message.assign(buffer, static_cast<size_t>(ret)); \
+    }
+
 #define ZLOGF(level, fmt, ...) \
     do { \
-        if (zlog::getLogger().shouldOutput(zlog::level)) { \
-            thread_local static char buffer[zlog::DEFAULT_MAX_MESSAGE_SIZE]; \
-            int ret = ZLOG_SNPRINTF(buffer, sizeof(buffer), fmt, ##__VA_ARGS__); \
-            if (ret > 0 && ret < static_cast<int>(sizeof(buffer))) { \
-                zlog::getLogger().logDirect(zlog::level, std::string(buffer), __FILE__, __FUNCTION__, __LINE__); \
+        if (zlog::getLogger().shouldOutput(zlog::level) && zlog::getLogger().shouldSample(zlog::level)) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty()) { \
+                zlog::getLogger().logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
+            } \
+        } \
+    } while(0)
+
+#define ZLOGF_TO(logger, level, fmt, ...) \
+    do { \
+        zlog::ZLogging& zlogTarget = (logger); \
+        if (zlogTarget.shouldOutput(zlog::level) && zlogTarget.shouldSample(zlog::level)) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty()) { \
+                zlogTarget.logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
+            } \
+        } \
+    } while(0)
+
+#define ZLOGF_SAMPLED(level, rate, fmt, ...) \
+    do { \
+        if (zlog::getLogger().shouldOutput(zlog::level) && \
+            zlog::getLogger().recordSample(zlog::ZLogSampler::sample(zlog::ZLogSampler::toThreshold(rate)))) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty()) { \
+                zlog::getLogger().logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
+            } \
+        } \
+    } while(0)
+
+#define ZLOGF_SAMPLED_BY(level, rate, key, fmt, ...) \
+    do { \
+        if (zlog::getLogger().shouldOutput(zlog::level) && \
+            zlog::getLogger().recordSample(zlog::ZLogSampler::sampleKey(zlog::ZLogSampler::toThreshold(rate), key))) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty()) { \
+                zlog::getLogger().logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
             } \
         } \
     } while(0)
@@ -497,6 +911,13 @@ namespace zlog {
 #define ZERRORF(fmt, ...)   ZLOGF(ERROR, fmt, ##__VA_ARGS__)
 #define ZFATALF(fmt, ...)   ZLOGF(FATAL, fmt, ##__VA_ARGS__)
 
+#define ZTRACEF_TO(logger, fmt, ...)   ZLOGF_TO(logger, TRACE, fmt, ##__VA_ARGS__)
+#define ZDEBUGF_TO(logger, fmt, ...)   ZLOGF_TO(logger, DEBUG, fmt, ##__VA_ARGS__)
+#define ZINFOF_TO(logger, fmt, ...)    ZLOGF_TO(logger, INFO, fmt, ##__VA_ARGS__)
+#define ZWARNINGF_TO(logger, fmt, ...) ZLOGF_TO(logger, WARNING, fmt, ##__VA_ARGS__)
+#define ZERRORF_TO(logger, fmt, ...)   ZLOGF_TO(logger, ERROR, fmt, ##__VA_ARGS__)
+#define ZFATALF_TO(logger, fmt, ...)   ZLOGF_TO(logger, FATAL, fmt, ##__VA_ARGS__)
+
 #define ZLOG_FUNCTION() \
     zlog::ZLogScope ZLOG_UNIQUE_VAR(scopedLogger)(__FUNCTION__, __FILE__, __LINE__)
 
@@ -542,6 +963,7 @@ namespace zlog {
     do { \
         if (!(condition)) { \
             ZFATALF("Check failed: %s at %s:%d", #condition, __FILE__, __LINE__); \
+            zlog::getLogger().flush(); \
             std::abort(); \
         } \
     } while(0)
@@ -557,43 +979,106 @@ namespace zlog {
 #define ZLOG_CONCAT(x, y) ZLOG_CONCAT_IMPL(x, y)
 #define ZLOG_UNIQUE_VAR(prefix) ZLOG_CONCAT(prefix, __LINE__)
 
-#define ZLOG_EVERY_N(level, n) \
-    static thread_local int ZLOG_UNIQUE_VAR(counter) = 0; \
-    if (++ZLOG_UNIQUE_VAR(counter) % (n) == 1) ZLOG(level)
+#define ZLOG_SITE(type, ...) \
+    ([]() -> type& { static type site{ __VA_ARGS__ }; return site; }())
 
-#define ZLOG_FIRST_N(level, n) \
-    static thread_local int ZLOG_UNIQUE_VAR(counter) = 0; \
-    if (++ZLOG_UNIQUE_VAR(counter) <= (n)) ZLOG(level)
+#define ZLOG_RATE_SITE(rate) \
+    ([]() -> zlog::ZLogRateLimiter& { using namespace zlog::rate_units; static zlog::ZLogRateLimiter site{ zlog::ZLogRate(rate) }; return site; }())
+
+#define ZLOG_EVERY_N(level, n) ZLOG_IF(level, ZLOG_SITE(zlog::ZLogSiteCounter).everyN(n))
+
+#define ZLOG_FIRST_N(level, n) ZLOG_IF(level, ZLOG_SITE(zlog::ZLogSiteCounter).firstN(n))
 
 #define ZLOG_ONCE(level) ZLOG_FIRST_N(level, 1)
 
-#define ZLOG_EVERY_T(level, periodSecond) \
-    static thread_local auto ZLOG_UNIQUE_VAR(lastTime) = std::chrono::steady_clock::now(); \
-    if (std::chrono::steady_clock::now() - ZLOG_UNIQUE_VAR(lastTime) >= std::chrono::seconds(periodSecond)) { \
-        ZLOG_UNIQUE_VAR(lastTime) = std::chrono::steady_clock::now(); \
-        ZLOG(level)
+#define ZLOG_EVERY_T(level, periodSecond) ZLOG_IF(level, ZLOG_SITE(zlog::ZLogSiteCounter).everyT(periodSecond))
+
+#define ZLOG_EVERY_T_END()
+
+#define ZLOG_RATE_LIMITED_TO(logger, level, rate) \
+    (zlog::admitRateLimited(logger, zlog::level, ZLOG_RATE_SITE(rate), __FILE__, __FUNCTION__, __LINE__) ? \
+     (logger).createStream(zlog::level, __FILE__, __FUNCTION__, __LINE__) : \
+     zlog::ZLogStream(nullptr, zlog::level, __FILE__, __FUNCTION__, __LINE__))
+
+#define ZLOG_RATE_LIMITED(level, rate) ZLOG_RATE_LIMITED_TO(zlog::getLogger(), level, rate)
+
+#define ZLOGF_RATE_LIMITED(level, rate, fmt, ...) \
+    do { \
+        if (zlog::admitRateLimited(zlog::getLogger(), zlog::level, ZLOG_RATE_SITE(rate), __FILE__, __FUNCTION__, __LINE__)) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty()) { \
+                zlog::getLogger().logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
+            } \
+        } \
+    } while(0)
+
+#define ZLOG_DEDUP(level, ...) ZLOG(level).withDedup(ZLOG_SITE(zlog::ZLogDedup, ##__VA_ARGS__))
 
-#define ZLOG_EVERY_T_END() }
+#define ZLOGF_DEDUP(level, windowSeconds, fmt, ...) \
+    do { \
+        if (zlog::getLogger().shouldOutput(zlog::level)) { \
+            std::string zlogMessage; \
+            ZLOG_FORMAT_MESSAGE(zlogMessage, fmt, ##__VA_ARGS__) \
+            if (!zlogMessage.empty() && zlog::admitDedup(zlog::getLogger(), zlog::level, \
+                ZLOG_SITE(zlog::ZLogDedup, windowSeconds), zlogMessage, __FILE__, __FUNCTION__, __LINE__)) { \
+                zlog::getLogger().logDirect(zlog::level, std::move(zlogMessage), __FILE__, __FUNCTION__, __LINE__); \
+            } \
+        } \
+    } while(0)
 
 #define ZLOG_CONSOLE_ONLY     zlog::CONSOLE_OUT
 #define ZLOG_FILE_ONLY        zlog::FILE_OUT
 #define ZLOG_BOTH            (zlog::CONSOLE_OUT | zlog::FILE_OUT)
 #define ZLOG_COLORED_CONSOLE (zlog::CONSOLE_OUT | zlog::COLOR_OUT)
-#define ZLOG_DEFAULT_MODE    (zlog::CONSOLE_OUT | zlog::FILE_OUT | zlog::COLOR_OUT)
+#define ZLOG_AUTO_COLOR_CONSOLE (zlog::CONSOLE_OUT | zlog::COLOR_AUTO)
+#define ZLOG_DEFAULT_MODE    (zlog::CONSOLE_OUT | zlog::FILE_OUT | zlog::COLOR_AUTO)
+
+#define ZLOG_GET_LOGGER(name)                 zlog::getLogger(name)
 
 #define ZLOG_INIT()                           zlog::getLogger().initialize()
 #define ZLOG_SET_PROGRAM_NAME(name)           zlog::getLogger().setProgramName(name)
 #define ZLOG_SET_OUTPUT_DIR(dir)              zlog::getLogger().setOutputDirectory(dir)
 #define ZLOG_SET_MAX_LOG_SIZE(size)           zlog::getLogger().setMaxLogSize(size)
 #define ZLOG_SET_MAX_CACHE_SIZE(size)         zlog::getLogger().setMaxCacheSize(size)
+#define ZLOG_SET_MAX_QUEUE_BYTES(bytes)       zlog::getLogger().setMaxQueueBytes(bytes)
+#define ZLOG_SET_QUEUE_BYTES_FROM_CGROUP(...) zlog::getLogger().setMaxQueueBytesFromCgroup(__VA_ARGS__)
 #define ZLOG_SET_MAX_BUFFER_SIZE(size)        zlog::getLogger().setMaxBufferSize(size)
 #define ZLOG_SET_MIN_LEVEL(level)             zlog::getLogger().setMinLevel(zlog::level)
 #define ZLOG_SET_OUTPUT_MODE(mode, ...)       zlog::getLogger().setOutputMode(mode, ##__VA_ARGS__)
 #define ZLOG_SET_FILE_MODE(mode)              zlog::getLogger().setFileMode(zlog::mode)
 #define ZLOG_SET_LEVEL_FILE(level, path)      zlog::getLogger().setLevelFile(zlog::level, path)
 #define ZLOG_SET_ROTATE_POLICY(policy)        zlog::getLogger().setRotatePolicy(zlog::policy)
-
-#define ZLOG_FLUSH()                          zlog::getLogger().flush()
+#define ZLOG_SET_ROTATE_INTERVAL(seconds, ...) zlog::getLogger().setRotateInterval(seconds, ##__VA_ARGS__)
+#define ZLOG_SET_DURABILITY(level, mode, ...) zlog::getLogger().setDurability(zlog::level, zlog::mode, ##__VA_ARGS__)
+#define ZLOG_SET_SYNC_INTERVAL(ms)            zlog::getLogger().setSyncInterval(ms)
+#define ZLOG_SET_SYNCHRONOUS(level, enable)   zlog::getLogger().setSynchronous(zlog::level, enable)
+#define ZLOG_SET_FORMAT_THREADS(count)        zlog::getLogger().setFormatThreads(count)
+#define ZLOG_SET_PREALLOCATE_SIZE(size)       zlog::getLogger().setPreallocateSize(size)
+#define ZLOG_SET_ROTATE_COMPRESSION(mode)     zlog::getLogger().setRotateCompression(zlog::mode)
+#define ZLOG_SET_STREAM_COMPRESSION(mode)     zlog::getLogger().setStreamCompression(zlog::mode)
+#define ZLOG_SET_RETENTION(maxFiles, ...)     zlog::getLogger().setRetention(maxFiles, ##__VA_ARGS__)
+#define ZLOG_SET_FILE_CACHE(maxFiles, ...)    zlog::getLogger().setFileCache(maxFiles, ##__VA_ARGS__)
+#define ZLOG_SET_CONSOLE_NONBLOCKING(enable, ...) zlog::getLogger().setConsoleNonBlocking(enable, ##__VA_ARGS__)
+#define ZLOG_SET_SYSLOG_TARGET(target, ...)   zlog::getLogger().setSyslogTarget(target, ##__VA_ARGS__)
+#define ZLOG_SET_TCP_TARGET(target, ...)      zlog::getLogger().setTcpTarget(target, ##__VA_ARGS__)
+#define ZLOG_SET_SPOOL_DIR(dir, ...)          zlog::getLogger().setSpoolDirectory(dir, ##__VA_ARGS__)
+#define ZLOG_SET_SHM_TARGET(name, ...)        zlog::getLogger().setShmTarget(name, ##__VA_ARGS__)
+#define ZLOG_SET_MEMORY_TARGET(records, ...)  zlog::getLogger().setMemoryTarget(records, ##__VA_ARGS__)
+#define ZLOG_QUERY_MEMORY(...)                zlog::getLogger().queryMemory(__VA_ARGS__)
+#define ZLOG_CLEAR_MEMORY()                   zlog::getLogger().clearMemory()
+#define ZLOG_SET_WORKER_POOL(pool)            zlog::getLogger().setWorkerPool(pool)
+#define ZLOG_SET_WORKER_SPIN(us)              zlog::getLogger().setWorkerSpin(us)
+#define ZLOG_SET_WORKER_AFFINITY(cpu)         zlog::getLogger().setWorkerAffinity(cpu)
+#define ZLOG_SET_WORKER_PRIORITY(priority)    zlog::getLogger().setWorkerPriority(priority)
+#define ZLOG_SET_SAMPLE_RATE(level, rate)     zlog::getLogger().setSampleRate(zlog::level, rate)
+
+#define ZLOG_FLUSH(...)                       zlog::getLogger().flush(__VA_ARGS__)
+#define ZLOG_SET_BACKTRACE(capacity, level)   zlog::getLogger().setBacktrace(capacity, zlog::level)
+#define ZLOG_SET_METRICS_EXPORT(path, ...)    zlog::getLogger().setMetricsExport(path, ##__VA_ARGS__)
+#define ZLOG_SET_SITE_STATS(enable)           zlog::getLogger().setSiteStats(enable)
+#define ZLOG_DUMP_BACKTRACE()                 zlog::getLogger().dumpBacktrace()
+#define ZLOG_INSTALL_CRASH_HANDLER(...)       zlog::getLogger().installCrashHandler(__VA_ARGS__)
 #define ZLOG_ROTATE()                         zlog::getLogger().rotateLogFiles()
 #define ZLOG_SHUTDOWN(...)                    zlog::getLogger().shutdown(__VA_ARGS__)
 
@@ -611,24 +1096,45 @@ namespace zlog {
 #define ZLOG_GET_TOTAL_COUNT()                zlog::getLogger().getTotalLogCount()
 #define ZLOG_GET_LEVEL_COUNT(level)           zlog::getLogger().getLogCount(zlog::level)
 #define ZLOG_GET_QUEUE_SIZE()                 zlog::getLogger().getQueueSize()
+#define ZLOG_GET_QUEUE_PEAK()                 zlog::getLogger().getQueueDepthPeak()
+#define ZLOG_GET_QUEUE_BYTES()                zlog::getLogger().getQueueBytes()
+#define ZLOG_GET_QUEUE_BYTES_PEAK()           zlog::getLogger().getQueueBytesPeak()
+#define ZLOG_GET_METRICS()                    zlog::getLogger().getMetrics()
+#define ZLOG_FORMAT_METRICS()                 zlog::getLogger().formatMetrics()
+#define ZLOG_REPORT_TOP_SITES(n)              zlog::getLogger().reportTopSites(n)
 #define ZLOG_GET_DROPPED_COUNT()              zlog::getLogger().getDroppedMessageCount()
+#define ZLOG_GET_SAMPLED_OUT_COUNT()          zlog::getLogger().getSampledOutCount()
+#define ZLOG_GET_CONSOLE_DROPPED_COUNT()      zlog::getLogger().getConsoleDroppedCount()
+#define ZLOG_GET_SYSLOG_DROPPED_COUNT()       zlog::getLogger().getSyslogDroppedCount()
+#define ZLOG_GET_TCP_DROPPED_COUNT()          zlog::getLogger().getTcpDroppedCount()
+#define ZLOG_GET_SHM_DROPPED_COUNT()          zlog::getLogger().getShmDroppedCount()
+#define ZLOG_GET_MEMORY_RECORD_COUNT()        zlog::getLogger().getMemoryRecordCount()
+#define ZLOG_GET_MEMORY_EVICTED_COUNT()       zlog::getLogger().getMemoryEvictedCount()
 
 #ifdef ZLOG_DISABLE_DEBUG
 #undef ZDEBUG
 #undef ZDEBUGF
 #undef ZDEBUG_IF
+#undef ZDEBUG_TO
+#undef ZDEBUGF_TO
 #define ZDEBUG              zlog::ZLogStream(nullptr, zlog::DEBUG, "", "", 0)
 #define ZDEBUGF(fmt, ...)   do {} while(0)
 #define ZDEBUG_IF(cond)     zlog::ZLogStream(nullptr, zlog::DEBUG, "", "", 0)
+#define ZDEBUG_TO(logger)   zlog::ZLogStream(nullptr, zlog::DEBUG, "", "", 0)
+#define ZDEBUGF_TO(logger, fmt, ...) do {} while(0)
 #endif
 
 #ifdef ZLOG_DISABLE_TRACE
 #undef ZTRACE
 #undef ZTRACEF
 #undef ZTRACE_IF
+#undef ZTRACE_TO
+#undef ZTRACEF_TO
 #define ZTRACE              zlog::ZLogStream(nullptr, zlog::TRACE, "", "", 0)
 #define ZTRACEF(fmt, ...)   do {} while(0)
 #define ZTRACE_IF(cond)     zlog::ZLogStream(nullptr, zlog::TRACE, "", "", 0)
+#define ZTRACE_TO(logger)   zlog::ZLogStream(nullptr, zlog::TRACE, "", "", 0)
+#define ZTRACEF_TO(logger, fmt, ...) do {} while(0)
 #endif
 
 #ifdef ZLOG_DISABLE_ALL
@@ -650,6 +1156,18 @@ namespace zlog {
 #undef ZWARNING_IF
 #undef ZERROR_IF
 #undef ZFATAL_IF
+#undef ZTRACE_TO
+#undef ZDEBUG_TO
+#undef ZINFO_TO
+#undef ZWARNING_TO
+#undef ZERROR_TO
+#undef ZFATAL_TO
+#undef ZTRACEF_TO
+#undef ZDEBUGF_TO
+#undef ZINFOF_TO
+#undef ZWARNINGF_TO
+#undef ZERRORF_TO
+#undef ZFATALF_TO
 
 #define ZTRACE              zlog::ZLogStream(nullptr, zlog::TRACE, "", "", 0)
 #define ZDEBUG              zlog::ZLogStream(nullptr, zlog::DEBUG, "", "", 0)
@@ -669,6 +1187,18 @@ namespace zlog {
 #define ZWARNING_IF(cond)   zlog::ZLogStream(nullptr, zlog::WARNING, "", "", 0)
 #define ZERROR_IF(cond)     zlog::ZLogStream(nullptr, zlog::ERROR, "", "", 0)
 #define ZFATAL_IF(cond)     zlog::ZLogStream(nullptr, zlog::FATAL, "", "", 0)
+#define ZTRACE_TO(logger)   zlog::ZLogStream(nullptr, zlog::TRACE, "", "", 0)
+#define ZDEBUG_TO(logger)   zlog::ZLogStream(nullptr, zlog::DEBUG, "", "", 0)
+#define ZINFO_TO(logger)    zlog::ZLogStream(nullptr, zlog::INFO, "", "", 0)
+#define ZWARNING_TO(logger) zlog::ZLogStream(nullptr, zlog::WARNING, "", "", 0)
+#define ZERROR_TO(logger)   zlog::ZLogStream(nullptr, zlog::ERROR, "", "", 0)
+#define ZFATAL_TO(logger)   zlog::ZLogStream(nullptr, zlog::FATAL, "", "", 0)
+#define ZTRACEF_TO(logger, fmt, ...)   do {} while(0)
+#define ZDEBUGF_TO(logger, fmt, ...)   do {} while(0)
+#define ZINFOF_TO(logger, fmt, ...)    do {} while(0)
+#define ZWARNINGF_TO(logger, fmt, ...) do {} while(0)
+#define ZERRORF_TO(logger, fmt, ...)   do {} while(0)
+#define ZFATALF_TO(logger, fmt, ...)   do {} while(0)
 #endif
 
 #endif // ! __ZLOG_LOGGING__
\ No newline at end of file
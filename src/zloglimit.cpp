@@ -0,0 +1,272 @@
+#include "zloglimit.h"
+
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+
+namespace zlog {
+
+	ZLogRateLimiter::ZLogRateLimiter(const ZLogRate& rate)
+		: intervalNs_(1)
+		, burstNs_(0)
+		, periodNs_(0)
+		, arrivalNs_(0)
+		, firstSuppressedNs_(0)
+		, suppressed_(0)
+		, tracked_(false) {
+		if (rate.count > 0 && rate.periodNs > 0) {
+			intervalNs_ = std::max<int64_t>(static_cast<int64_t>(rate.periodNs / rate.count), 1);
+			burstNs_ = std::max<int64_t>(rate.periodNs - intervalNs_, 0);
+			periodNs_ = rate.periodNs;
+		}
+		else {
+			intervalNs_ = INT64_MAX / 4;
+		}
+	}
+
+	bool ZLogRateLimiter::tryAcquire(uint64_t& suppressed, int64_t& suppressedNs) {
+		int64_t now = getMonotonicNs();
+		int64_t arrival = arrivalNs_.load(std::memory_order_relaxed);
+
+		while (true) {
+			int64_t next = std::max(arrival, now);
+			if (next - now > burstNs_) {
+				int64_t expected = 0;
+				if (suppressed_.fetch_add(1, std::memory_order_relaxed) == 0) {
+					firstSuppressedNs_.compare_exchange_strong(expected, now, std::memory_order_relaxed);
+				}
+				return false;
+			}
+
+			if (arrivalNs_.compare_exchange_weak(arrival, next + intervalNs_, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+
+		int64_t first = firstSuppressedNs_.load(std::memory_order_relaxed);
+		if (first > 0 && now - first >= periodNs_) {
+			takeSuppressed(now, suppressed, suppressedNs);
+		}
+		else {
+			suppressed = 0;
+			suppressedNs = 0;
+		}
+		return true;
+	}
+
+	bool ZLogRateLimiter::takeExpired(bool force, uint64_t& suppressed, int64_t& suppressedNs) {
+		int64_t now = getMonotonicNs();
+		int64_t first = firstSuppressedNs_.load(std::memory_order_relaxed);
+		if (first == 0 || (!force && now - first < periodNs_)) {
+			return false;
+		}
+		return takeSuppressed(now, suppressed, suppressedNs);
+	}
+
+	bool ZLogRateLimiter::markTracked() {
+		if (tracked_.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		return !tracked_.exchange(true);
+	}
+
+	uint64_t ZLogRateLimiter::getSuppressedCount() const {
+		return suppressed_.load(std::memory_order_relaxed);
+	}
+
+	bool ZLogRateLimiter::takeSuppressed(int64_t now, uint64_t& suppressed, int64_t& suppressedNs) {
+		suppressed = 0;
+		suppressedNs = 0;
+
+		int64_t first = firstSuppressedNs_.load(std::memory_order_relaxed);
+		if (first > 0 && firstSuppressedNs_.compare_exchange_strong(first, 0, std::memory_order_relaxed)) {
+			suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+			suppressedNs = now - first;
+		}
+		return suppressed > 0;
+	}
+
+	ZLogDedup::ZLogDedup(int windowSeconds)
+		: windowNs_(static_cast<int64_t>(std::max(windowSeconds, 0)) * 1000 * 1000 * 1000)
+		, nextSlot_(0)
+		, firstSuppressedNs_(0)
+		, lastSuppressedNs_(0)
+		, suppressed_(0)
+		, tracked_(false) {
+		for (size_t i = 0; i < DEDUP_HISTORY_SIZE; ++i) {
+			hashes_[i].store(0, std::memory_order_relaxed);
+			startNs_[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	bool ZLogDedup::admit(const std::string& message, uint64_t& suppressed, int64_t& suppressedNs) {
+		uint64_t hash = hashMessage(message);
+		int64_t now = getMonotonicNs();
+
+		size_t slot = DEDUP_HISTORY_SIZE;
+		for (size_t i = 0; i < DEDUP_HISTORY_SIZE; ++i) {
+			if (hashes_[i].load(std::memory_order_relaxed) != hash) {
+				continue;
+			}
+			int64_t start = startNs_[i].load(std::memory_order_relaxed);
+			if (start > 0 && now - start < windowNs_) {
+				int64_t expected = 0;
+				if (suppressed_.fetch_add(1, std::memory_order_relaxed) == 0) {
+					firstSuppressedNs_.compare_exchange_strong(expected, now, std::memory_order_relaxed);
+				}
+				lastSuppressedNs_.store(now, std::memory_order_relaxed);
+				return false;
+			}
+			slot = i;
+			break;
+		}
+
+		if (slot == DEDUP_HISTORY_SIZE) {
+			slot = nextSlot_.fetch_add(1, std::memory_order_relaxed) % DEDUP_HISTORY_SIZE;
+		}
+		hashes_[slot].store(hash, std::memory_order_relaxed);
+		startNs_[slot].store(now, std::memory_order_relaxed);
+
+		takeSuppressed(now, suppressed, suppressedNs);
+		return true;
+	}
+
+	bool ZLogDedup::takeExpired(bool force, uint64_t& suppressed, int64_t& suppressedNs) {
+		int64_t now = getMonotonicNs();
+		if (firstSuppressedNs_.load(std::memory_order_relaxed) == 0 ||
+			(!force && now - lastSuppressedNs_.load(std::memory_order_relaxed) < windowNs_)) {
+			return false;
+		}
+		return takeSuppressed(now, suppressed, suppressedNs);
+	}
+
+	bool ZLogDedup::markTracked() {
+		if (tracked_.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		return !tracked_.exchange(true);
+	}
+
+	uint64_t ZLogDedup::getSuppressedCount() const {
+		return suppressed_.load(std::memory_order_relaxed);
+	}
+
+	bool ZLogDedup::takeSuppressed(int64_t now, uint64_t& suppressed, int64_t& suppressedNs) {
+		suppressed = 0;
+		suppressedNs = 0;
+
+		int64_t first = firstSuppressedNs_.load(std::memory_order_relaxed);
+		if (first > 0 && firstSuppressedNs_.compare_exchange_strong(first, 0, std::memory_order_relaxed)) {
+			suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+			suppressedNs = now - first;
+		}
+		return suppressed > 0;
+	}
+
+	ZLogSiteCounter::ZLogSiteCounter()
+		: count_(0)
+		, lastNs_(0) {
+	}
+
+	bool ZLogSiteCounter::everyN(int n) {
+		if (n <= 0) {
+			return false;
+		}
+		return count_.fetch_add(1, std::memory_order_relaxed) % static_cast<uint64_t>(n) == 0;
+	}
+
+	bool ZLogSiteCounter::firstN(int n) {
+		if (n <= 0 || count_.load(std::memory_order_relaxed) >= static_cast<uint64_t>(n)) {
+			return false;
+		}
+		return count_.fetch_add(1, std::memory_order_relaxed) < static_cast<uint64_t>(n);
+	}
+
+	bool ZLogSiteCounter::everyT(int periodSeconds) {
+		int64_t now = getMonotonicNs();
+		int64_t last = lastNs_.load(std::memory_order_relaxed);
+
+		if (last == 0) {
+			lastNs_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+			return false;
+		}
+
+		int64_t periodNs = static_cast<int64_t>(periodSeconds) * 1000 * 1000 * 1000;
+		if (now - last < periodNs) {
+			return false;
+		}
+		return lastNs_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+	}
+
+	uint64_t ZLogSampler::toThreshold(double rate) {
+		if (!(rate > 0.0)) {
+			return 0;
+		}
+		if (rate >= 1.0) {
+			return ZLOG_SAMPLE_ALWAYS;
+		}
+		return static_cast<uint64_t>(rate * static_cast<double>(ZLOG_SAMPLE_ALWAYS));
+	}
+
+	double ZLogSampler::toRate(uint64_t threshold) {
+		return static_cast<double>(std::min(threshold, ZLOG_SAMPLE_ALWAYS)) / static_cast<double>(ZLOG_SAMPLE_ALWAYS);
+	}
+
+	bool ZLogSampler::sample(uint64_t threshold) {
+		if (threshold >= ZLOG_SAMPLE_ALWAYS) {
+			return true;
+		}
+		if (threshold == 0) {
+			return false;
+		}
+		return (nextRandom() >> 32) < threshold;
+	}
+
+	bool ZLogSampler::sampleKey(uint64_t threshold, uint64_t key) {
+		if (threshold >= ZLOG_SAMPLE_ALWAYS) {
+			return true;
+		}
+		return (mix(key) >> 32) < threshold;
+	}
+
+	bool ZLogSampler::sampleKey(uint64_t threshold, const std::string& key) {
+		return sampleKey(threshold, hashMessage(key));
+	}
+
+	uint64_t ZLogSampler::nextRandom() {
+		thread_local uint64_t state = static_cast<uint64_t>(getMonotonicNs())
+			^ static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		state += 0x9E3779B97F4A7C15ULL;
+		return mix(state);
+	}
+
+	uint64_t ZLogSampler::mix(uint64_t value) {
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+
+	int64_t getMonotonicNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t hashMessage(const std::string& message) {
+		uint64_t hash = 14695981039346656037ULL;
+		for (unsigned char c : message) {
+			hash ^= c;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	std::string formatSuppressedSummary(uint64_t suppressed, int64_t suppressedNs) {
+		char buffer[128];
+		std::snprintf(buffer, sizeof(buffer), "suppressed %llu similar messages in %.1fs",
+			static_cast<unsigned long long>(suppressed), suppressedNs / 1e9);
+		return buffer;
+	}
+
+} // namespace zlog
@@ -0,0 +1,113 @@
+#ifndef __ZLOG_LIMIT__
+#define __ZLOG_LIMIT__
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const int      DEFAULT_DEDUP_WINDOW_SECONDS = 5;
+	static const size_t   DEDUP_HISTORY_SIZE           = 4;
+	static const uint64_t ZLOG_SAMPLE_ALWAYS           = 1ULL << 32;
+
+	struct ZLogRate {
+		double count;
+		int64_t periodNs;
+	};
+
+	struct ZLogRateUnit {
+		int64_t periodNs;
+	};
+
+	inline ZLogRate operator/(double count, ZLogRateUnit unit) {
+		return ZLogRate{ count, unit.periodNs };
+	}
+
+	namespace rate_units {
+		static const ZLogRateUnit ms  = { 1000LL * 1000 };
+		static const ZLogRateUnit s   = { 1000LL * 1000 * 1000 };
+		static const ZLogRateUnit min = { 60LL * 1000 * 1000 * 1000 };
+		static const ZLogRateUnit h   = { 3600LL * 1000 * 1000 * 1000 };
+	} // namespace rate_units
+
+	class ZLogRateLimiter {
+	public:
+		explicit ZLogRateLimiter(const ZLogRate& rate);
+
+		bool tryAcquire(uint64_t& suppressed, int64_t& suppressedNs);
+		bool takeExpired(bool force, uint64_t& suppressed, int64_t& suppressedNs);
+		bool markTracked();
+
+		uint64_t getSuppressedCount() const;
+
+	private:
+		bool takeSuppressed(int64_t now, uint64_t& suppressed, int64_t& suppressedNs);
+
+		int64_t intervalNs_;
+		int64_t burstNs_;
+		int64_t periodNs_;
+		std::atomic<int64_t> arrivalNs_;
+		std::atomic<int64_t> firstSuppressedNs_;
+		std::atomic<uint64_t> suppressed_;
+		std::atomic<bool> tracked_;
+	};
+
+	class ZLogDedup {
+	public:
+		explicit ZLogDedup(int windowSeconds = DEFAULT_DEDUP_WINDOW_SECONDS);
+
+		bool admit(const std::string& message, uint64_t& suppressed, int64_t& suppressedNs);
+		bool takeExpired(bool force, uint64_t& suppressed, int64_t& suppressedNs);
+		bool markTracked();
+
+		uint64_t getSuppressedCount() const;
+
+	private:
+		bool takeSuppressed(int64_t now, uint64_t& suppressed, int64_t& suppressedNs);
+
+		int64_t windowNs_;
+		std::atomic<uint64_t> hashes_[DEDUP_HISTORY_SIZE];
+		std::atomic<int64_t> startNs_[DEDUP_HISTORY_SIZE];
+		std::atomic<size_t> nextSlot_;
+		std::atomic<int64_t> firstSuppressedNs_;
+		std::atomic<int64_t> lastSuppressedNs_;
+		std::atomic<uint64_t> suppressed_;
+		std::atomic<bool> tracked_;
+	};
+
+	class ZLogSiteCounter {
+	public:
+		ZLogSiteCounter();
+
+		bool everyN(int n);
+		bool firstN(int n);
+		bool everyT(int periodSeconds);
+
+	private:
+		std::atomic<uint64_t> count_;
+		std::atomic<int64_t> lastNs_;
+	};
+
+	class ZLogSampler {
+	public:
+		static uint64_t toThreshold(double rate);
+		static double toRate(uint64_t threshold);
+
+		static bool sample(uint64_t threshold);
+		static bool sampleKey(uint64_t threshold, uint64_t key);
+		static bool sampleKey(uint64_t threshold, const std::string& key);
+
+	private:
+		static uint64_t nextRandom();
+		static uint64_t mix(uint64_t value);
+	};
+
+	int64_t getMonotonicNs();
+	uint64_t hashMessage(const std::string& message);
+	std::string formatSuppressedSummary(uint64_t suppressed, int64_t suppressedNs);
+
+} // namespace zlog
+
+#endif // ! __ZLOG_LIMIT__
@@ -0,0 +1,142 @@
+#include "zlogmemory.h"
+
+#include <algorithm>
+
+namespace zlog {
+
+	ZLogMemorySink::ZLogMemorySink()
+		: capacity_(0)
+		, maxBytes_(0)
+		, opened_(false)
+		, head_(0)
+		, tail_(0)
+		, bytes_(0)
+		, evictedCount_(0) {
+	}
+
+	ZLogMemorySink::~ZLogMemorySink() {
+	}
+
+	int ZLogMemorySink::open(size_t maxRecords, size_t maxBytes) {
+		if (opened_.load()) {
+			return -1;
+		}
+		if (maxRecords == 0) {
+			return -1;
+		}
+
+		slots_.reset(new std::shared_ptr<const ZLogMemoryRecord>[maxRecords]);
+		capacity_ = maxRecords;
+		maxBytes_ = maxBytes;
+		opened_.store(true, std::memory_order_release);
+		return 0;
+	}
+
+	int ZLogMemorySink::write(int level, std::chrono::system_clock::time_point timestamp, const char* data, size_t size) {
+		if (!opened_.load(std::memory_order_acquire)) {
+			return -1;
+		}
+
+		uint64_t index = head_.load(std::memory_order_relaxed);
+
+		std::shared_ptr<ZLogMemoryRecord> record = std::make_shared<ZLogMemoryRecord>();
+		record->index = index;
+		record->level = level;
+		record->timestamp = timestamp;
+		record->text.assign(data, size);
+
+		bytes_.fetch_add(size, std::memory_order_relaxed);
+
+		uint64_t tail = tail_.load(std::memory_order_relaxed);
+		while (tail < index && (index - tail >= capacity_ ||
+			(maxBytes_ > 0 && bytes_.load(std::memory_order_relaxed) > maxBytes_))) {
+			if (evict(tail)) {
+				evictedCount_.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		tail_.store(tail, std::memory_order_release);
+
+		std::atomic_store(&slots_[index % capacity_], std::shared_ptr<const ZLogMemoryRecord>(std::move(record)));
+		head_.store(index + 1, std::memory_order_release);
+		return 0;
+	}
+
+	void ZLogMemorySink::clear() {
+		if (!opened_.load(std::memory_order_acquire)) {
+			return;
+		}
+
+		uint64_t head = head_.load(std::memory_order_relaxed);
+		uint64_t tail = tail_.load(std::memory_order_relaxed);
+		while (tail < head) {
+			evict(tail);
+		}
+		tail_.store(tail, std::memory_order_release);
+	}
+
+	std::vector<ZLogMemoryRecord> ZLogMemorySink::query(const ZLogMemoryQuery& query) const {
+		std::vector<ZLogMemoryRecord> records;
+		if (!opened_.load(std::memory_order_acquire)) {
+			return records;
+		}
+
+		uint64_t tail = tail_.load(std::memory_order_acquire);
+		uint64_t head = head_.load(std::memory_order_acquire);
+		if (head - tail > capacity_) {
+			tail = head - capacity_;
+		}
+
+		for (uint64_t i = head; i > tail; --i) {
+			if (query.limit > 0 && records.size() >= query.limit) {
+				break;
+			}
+
+			std::shared_ptr<const ZLogMemoryRecord> record = std::atomic_load(&slots_[(i - 1) % capacity_]);
+			if (!record || record->index != i - 1) {
+				continue;
+			}
+			if (record->level < query.minLevel ||
+				record->timestamp < query.begin || record->timestamp > query.end) {
+				continue;
+			}
+			if (!query.contains.empty() && record->text.find(query.contains) == std::string::npos) {
+				continue;
+			}
+			records.push_back(*record);
+		}
+
+		std::reverse(records.begin(), records.end());
+		return records;
+	}
+
+	bool ZLogMemorySink::isOpen() const {
+		return opened_.load(std::memory_order_acquire);
+	}
+
+	size_t ZLogMemorySink::getRecordCount() const {
+		uint64_t tail = tail_.load();
+		return static_cast<size_t>(head_.load() - tail);
+	}
+
+	size_t ZLogMemorySink::getByteSize() const {
+		return bytes_.load();
+	}
+
+	size_t ZLogMemorySink::getEvictedCount() const {
+		return evictedCount_.load();
+	}
+
+	bool ZLogMemorySink::evict(uint64_t& tail) {
+		std::shared_ptr<const ZLogMemoryRecord>& slot = slots_[tail % capacity_];
+		std::shared_ptr<const ZLogMemoryRecord> record = std::atomic_load(&slot);
+		if (record && record->index == tail) {
+			bytes_.fetch_sub(record->text.size(), std::memory_order_relaxed);
+			std::atomic_store(&slot, std::shared_ptr<const ZLogMemoryRecord>());
+			++tail;
+			return true;
+		}
+		++tail;
+		return false;
+	}
+
+} // namespace zlog
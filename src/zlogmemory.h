@@ -0,0 +1,75 @@
+#ifndef __ZLOG_MEMORY__
+#define __ZLOG_MEMORY__
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const size_t DEFAULT_MEMORY_MAX_RECORDS = 1000;
+	static const size_t DEFAULT_MEMORY_MAX_BYTES   = 1024 * 1024;
+
+	struct ZLogMemoryRecord {
+		uint64_t index;
+		int level;
+		std::chrono::system_clock::time_point timestamp;
+		std::string text;
+	};
+
+	struct ZLogMemoryQuery {
+		int minLevel;
+		std::chrono::system_clock::time_point begin;
+		std::chrono::system_clock::time_point end;
+		std::string contains;
+		size_t limit;
+
+		ZLogMemoryQuery()
+			: minLevel(0)
+			, begin(std::chrono::system_clock::time_point::min())
+			, end(std::chrono::system_clock::time_point::max())
+			, limit(0) {
+		}
+	};
+
+	class ZLogMemorySink {
+	public:
+		ZLogMemorySink();
+		~ZLogMemorySink();
+
+		ZLogMemorySink(const ZLogMemorySink&) = delete;
+		ZLogMemorySink& operator=(const ZLogMemorySink&) = delete;
+
+		int open(size_t maxRecords, size_t maxBytes);
+
+		int write(int level, std::chrono::system_clock::time_point timestamp, const char* data, size_t size);
+		void clear();
+
+		std::vector<ZLogMemoryRecord> query(const ZLogMemoryQuery& query) const;
+
+		bool isOpen() const;
+		size_t getRecordCount() const;
+		size_t getByteSize() const;
+		size_t getEvictedCount() const;
+
+	private:
+		bool evict(uint64_t& tail);
+
+	private:
+		std::unique_ptr<std::shared_ptr<const ZLogMemoryRecord>[]> slots_;
+		size_t capacity_;
+		size_t maxBytes_;
+		std::atomic<bool> opened_;
+		std::atomic<uint64_t> head_;
+		std::atomic<uint64_t> tail_;
+		std::atomic<size_t> bytes_;
+		std::atomic<size_t> evictedCount_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_MEMORY__
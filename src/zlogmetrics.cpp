@@ -0,0 +1,177 @@
+#include "zlogmetrics.h"
+
+#include <cstdio>
+
+namespace zlog {
+
+	static const size_t ZLOG_HISTOGRAM_SUB_COUNT = static_cast<size_t>(1) << ZLOG_HISTOGRAM_SUB_BITS;
+
+	static int getHighestBit(uint64_t value) {
+		int bit = 0;
+		while (value >>= 1) {
+			++bit;
+		}
+		return bit;
+	}
+
+	uint64_t ZLogHistogramSnapshot::percentile(double p) const {
+		if (count == 0) {
+			return 0;
+		}
+
+		uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count));
+		if (target == 0) {
+			target = 1;
+		}
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < buckets.size(); ++i) {
+			seen += buckets[i];
+			if (seen >= target) {
+				uint64_t upper = ZLogHistogram::getBucketUpper(i);
+				return upper < max ? upper : max;
+			}
+		}
+		return max;
+	}
+
+	uint64_t ZLogHistogramSnapshot::countBelow(uint64_t bound) const {
+		uint64_t total = 0;
+		for (size_t i = 0; i < buckets.size(); ++i) {
+			if (ZLogHistogram::getBucketUpper(i) >= bound) {
+				break;
+			}
+			total += buckets[i];
+		}
+		return total;
+	}
+
+	ZLogHistogram::ZLogHistogram()
+		: sum_(0)
+		, max_(0) {
+		for (auto& bucket : buckets_) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void ZLogHistogram::record(uint64_t value) {
+		std::atomic<uint64_t>& bucket = buckets_[getBucketIndex(value)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		if (value > max_.load(std::memory_order_relaxed)) {
+			max_.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	ZLogHistogramSnapshot ZLogHistogram::snapshot() const {
+		ZLogHistogramSnapshot result;
+		result.sum = sum_.load(std::memory_order_relaxed);
+		result.max = max_.load(std::memory_order_relaxed);
+
+		size_t last = 0;
+		for (size_t i = 0; i < ZLOG_HISTOGRAM_BUCKETS; ++i) {
+			if (buckets_[i].load(std::memory_order_relaxed) != 0) {
+				last = i + 1;
+			}
+		}
+
+		result.buckets.resize(last);
+		for (size_t i = 0; i < last; ++i) {
+			result.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+			result.count += result.buckets[i];
+		}
+		return result;
+	}
+
+	size_t ZLogHistogram::getBucketIndex(uint64_t value) {
+		if (value < ZLOG_HISTOGRAM_SUB_COUNT) {
+			return static_cast<size_t>(value);
+		}
+
+		int exponent = getHighestBit(value);
+		size_t sub = static_cast<size_t>(value >> (exponent - ZLOG_HISTOGRAM_SUB_BITS)) & (ZLOG_HISTOGRAM_SUB_COUNT - 1);
+		return (exponent - ZLOG_HISTOGRAM_SUB_BITS + 1) * ZLOG_HISTOGRAM_SUB_COUNT + sub;
+	}
+
+	uint64_t ZLogHistogram::getBucketLower(size_t index) {
+		if (index < ZLOG_HISTOGRAM_SUB_COUNT) {
+			return index;
+		}
+
+		size_t exponent = index / ZLOG_HISTOGRAM_SUB_COUNT + ZLOG_HISTOGRAM_SUB_BITS - 1;
+		uint64_t sub = index % ZLOG_HISTOGRAM_SUB_COUNT;
+		return (ZLOG_HISTOGRAM_SUB_COUNT + sub) << (exponent - ZLOG_HISTOGRAM_SUB_BITS);
+	}
+
+	uint64_t ZLogHistogram::getBucketUpper(size_t index) {
+		if (index + 1 >= ZLOG_HISTOGRAM_BUCKETS) {
+			return UINT64_MAX;
+		}
+		return getBucketLower(index + 1) - 1;
+	}
+
+	static std::string formatNumber(double value) {
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%.12g", value);
+		return buffer;
+	}
+
+	static void appendHistogram(std::string& output, const std::string& name, const std::string& help,
+		const std::string& labels, const ZLogHistogramSnapshot& histogram, int minBit, int maxBit, bool seconds) {
+		output += "# HELP " + name + " " + help + "\n";
+		output += "# TYPE " + name + " histogram\n";
+
+		for (int bit = minBit; bit <= maxBit; ++bit) {
+			uint64_t bound = static_cast<uint64_t>(1) << bit;
+			std::string le = seconds ? formatNumber(bound / 1e9) : std::to_string(bound - 1);
+			output += name + "_bucket{" + labels + ",le=\"" + le + "\"} " + std::to_string(histogram.countBelow(bound)) + "\n";
+		}
+		output += name + "_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(histogram.count) + "\n";
+		output += name + "_sum{" + labels + "} " + (seconds ? formatNumber(histogram.sum / 1e9) : std::to_string(histogram.sum)) + "\n";
+		output += name + "_count{" + labels + "} " + std::to_string(histogram.count) + "\n";
+	}
+
+	static void appendValue(std::string& output, const std::string& name, const char* type, const std::string& help,
+		const std::string& labels, size_t value) {
+		output += "# HELP " + name + " " + help + "\n";
+		output += "# TYPE " + name + " " + type + "\n";
+		output += name + "{" + labels + "} " + std::to_string(value) + "\n";
+	}
+
+	std::string formatPrometheusMetrics(const std::string& logger, const ZLogMetrics& metrics) {
+		std::string labels = "logger=\"";
+		for (char c : logger) {
+			if (c == '\\' || c == '"') {
+				labels += '\\';
+			}
+			labels += (c == '\n') ? ' ' : c;
+		}
+		labels += '"';
+
+		std::string output;
+		appendHistogram(output, "zlog_queue_latency_seconds", "Time from the log call until the worker dequeues the entry.",
+			labels, metrics.queueLatencyNs, 10, 34, true);
+		appendHistogram(output, "zlog_batch_format_seconds", "Time spent formatting one worker batch.",
+			labels, metrics.formatNs, 10, 34, true);
+		appendHistogram(output, "zlog_batch_write_seconds", "Time spent writing and flushing one worker batch.",
+			labels, metrics.writeNs, 10, 34, true);
+		appendHistogram(output, "zlog_batch_size", "Number of entries in one worker batch.",
+			labels, metrics.batchSize, 0, 12, false);
+		appendValue(output, "zlog_queue_depth", "gauge", "Entries waiting in the queue.",
+			labels, metrics.queueDepth);
+		appendValue(output, "zlog_queue_depth_peak", "gauge", "Highest queue depth observed.",
+			labels, metrics.queueDepthPeak);
+		appendValue(output, "zlog_queue_bytes", "gauge", "Bytes held by entries waiting in the queue.",
+			labels, metrics.queueBytes);
+		appendValue(output, "zlog_queue_bytes_peak", "gauge", "Highest queued byte count observed.",
+			labels, metrics.queueBytesPeak);
+		appendValue(output, "zlog_messages_total", "counter", "Entries accepted by the logger.",
+			labels, metrics.totalCount);
+		appendValue(output, "zlog_dropped_total", "counter", "Entries dropped because the queue was full.",
+			labels, metrics.droppedCount);
+		appendValue(output, "zlog_sampled_out_total", "counter", "Entries skipped by sampling.",
+			labels, metrics.sampledOutCount);
+		return output;
+	}
+
+} // namespace zlog
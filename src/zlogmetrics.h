@@ -0,0 +1,76 @@
+#ifndef __ZLOG_METRICS__
+#define __ZLOG_METRICS__
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const size_t ZLOG_HISTOGRAM_SUB_BITS     = 2;
+	static const size_t ZLOG_HISTOGRAM_BUCKETS      = (64 - ZLOG_HISTOGRAM_SUB_BITS + 1) << ZLOG_HISTOGRAM_SUB_BITS;
+	static const int    DEFAULT_METRICS_INTERVAL_MS = 10 * 1000;
+
+	struct ZLogHistogramSnapshot {
+		uint64_t count;
+		uint64_t sum;
+		uint64_t max;
+		std::vector<uint64_t> buckets;
+
+		ZLogHistogramSnapshot() : count(0), sum(0), max(0) {}
+
+		uint64_t percentile(double p) const;
+		uint64_t countBelow(uint64_t bound) const;
+	};
+
+	class ZLogHistogram {
+	public:
+		ZLogHistogram();
+
+		ZLogHistogram(const ZLogHistogram&) = delete;
+		ZLogHistogram& operator=(const ZLogHistogram&) = delete;
+
+		void record(uint64_t value);
+		ZLogHistogramSnapshot snapshot() const;
+
+		static size_t getBucketIndex(uint64_t value);
+		static uint64_t getBucketLower(size_t index);
+		static uint64_t getBucketUpper(size_t index);
+
+	private:
+		std::atomic<uint64_t> buckets_[ZLOG_HISTOGRAM_BUCKETS];
+		std::atomic<uint64_t> sum_;
+		std::atomic<uint64_t> max_;
+	};
+
+	struct ZLogMetrics {
+		ZLogHistogramSnapshot queueLatencyNs;
+		ZLogHistogramSnapshot formatNs;
+		ZLogHistogramSnapshot writeNs;
+		ZLogHistogramSnapshot batchSize;
+		size_t queueDepth;
+		size_t queueDepthPeak;
+		size_t queueBytes;
+		size_t queueBytesPeak;
+		size_t totalCount;
+		size_t droppedCount;
+		size_t sampledOutCount;
+
+		ZLogMetrics()
+			: queueDepth(0)
+			, queueDepthPeak(0)
+			, queueBytes(0)
+			, queueBytesPeak(0)
+			, totalCount(0)
+			, droppedCount(0)
+			, sampledOutCount(0) {
+		}
+	};
+
+	std::string formatPrometheusMetrics(const std::string& logger, const ZLogMetrics& metrics);
+
+} // namespace zlog
+
+#endif // ! __ZLOG_METRICS__
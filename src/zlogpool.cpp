@@ -0,0 +1,290 @@
+#include "zlogpool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace zlog {
+
+	ZLogFormatPool::ZLogFormatPool()
+		: generation_(0)
+		, stopping_(false) {
+	}
+
+	ZLogFormatPool::~ZLogFormatPool() {
+		stop();
+	}
+
+	int ZLogFormatPool::start(size_t threadCount) {
+		if (threadCount > MAX_FORMAT_THREADS) {
+			return -1;
+		}
+
+		stop();
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = false;
+		for (size_t i = 0; i < threadCount; ++i) {
+			threads_.emplace_back(&ZLogFormatPool::runWorker, this);
+		}
+		return 0;
+	}
+
+	void ZLogFormatPool::stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		condition_.notify_all();
+
+		for (auto& thread : threads_) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+		threads_.clear();
+	}
+
+	void ZLogFormatPool::run(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& fn) {
+		if (count == 0) {
+			return;
+		}
+
+		chunkSize = std::max<size_t>(chunkSize, 1);
+		if (threads_.empty() || count <= chunkSize) {
+			fn(0, count);
+			return;
+		}
+
+		std::shared_ptr<Job> job = std::make_shared<Job>();
+		job->fn = &fn;
+		job->count = count;
+		job->chunkSize = chunkSize;
+		job->next.store(0);
+		job->remaining.store(count);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			job_ = job;
+			++generation_;
+		}
+		condition_.notify_all();
+
+		runChunks(*job);
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		doneCondition_.wait(lock, [&job] {
+			return job->remaining.load() == 0;
+			});
+		job_.reset();
+	}
+
+	size_t ZLogFormatPool::getThreadCount() const {
+		return threads_.size();
+	}
+
+	void ZLogFormatPool::runWorker() {
+		uint64_t seen = 0;
+
+		while (true) {
+			std::shared_ptr<Job> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this, seen] {
+					return stopping_ || generation_ != seen;
+					});
+
+				if (stopping_) {
+					break;
+				}
+				seen = generation_;
+				job = job_;
+			}
+
+			if (job) {
+				runChunks(*job);
+			}
+		}
+	}
+
+	void ZLogFormatPool::runChunks(Job& job) {
+		while (true) {
+			size_t begin = job.next.fetch_add(job.chunkSize);
+			if (begin >= job.count) {
+				break;
+			}
+
+			size_t end = std::min(begin + job.chunkSize, job.count);
+			(*job.fn)(begin, end);
+
+			if (job.remaining.fetch_sub(end - begin) == end - begin) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				doneCondition_.notify_all();
+			}
+		}
+	}
+
+	struct ZLogWorkerPool::Client {
+		std::function<bool()> run;
+		std::function<int()> getTimeout;
+		bool queued;
+		bool running;
+		bool rerun;
+		bool detached;
+		int probing;
+	};
+
+	ZLogWorkerPool::ZLogWorkerPool(size_t threadCount)
+		: stopping_(false) {
+		threadCount = std::max<size_t>(threadCount, 1);
+		for (size_t i = 0; i < threadCount; ++i) {
+			threads_.emplace_back(&ZLogWorkerPool::runWorker, this);
+		}
+	}
+
+	ZLogWorkerPool::~ZLogWorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		condition_.notify_all();
+
+		for (auto& thread : threads_) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+	}
+
+	ZLogWorkerPool& ZLogWorkerPool::getShared() {
+		static ZLogWorkerPool* pool = new ZLogWorkerPool(DEFAULT_WORKER_POOL_THREADS);
+		return *pool;
+	}
+
+	std::shared_ptr<ZLogWorkerPool::Client> ZLogWorkerPool::attach(std::function<bool()> run, std::function<int()> getTimeout) {
+		std::shared_ptr<Client> client = std::make_shared<Client>();
+		client->run = std::move(run);
+		client->getTimeout = std::move(getTimeout);
+		client->queued = false;
+		client->running = false;
+		client->rerun = false;
+		client->detached = false;
+		client->probing = 0;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		clients_.push_back(client);
+		return client;
+	}
+
+	void ZLogWorkerPool::detach(const std::shared_ptr<Client>& client) {
+		if (!client) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		client->detached = true;
+		clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+		runQueue_.erase(std::remove(runQueue_.begin(), runQueue_.end(), client), runQueue_.end());
+		client->queued = false;
+
+		idleCondition_.wait(lock, [&client] {
+			return !client->running && client->probing == 0;
+			});
+	}
+
+	void ZLogWorkerPool::schedule(const std::shared_ptr<Client>& client) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (client->detached) {
+			return;
+		}
+		if (client->running) {
+			client->rerun = true;
+			return;
+		}
+		enqueue(client);
+	}
+
+	size_t ZLogWorkerPool::getThreadCount() const {
+		return threads_.size();
+	}
+
+	void ZLogWorkerPool::enqueue(const std::shared_ptr<Client>& client) {
+		if (!client->queued) {
+			client->queued = true;
+			runQueue_.push_back(client);
+			condition_.notify_one();
+		}
+	}
+
+	void ZLogWorkerPool::runWorker() {
+		while (true) {
+			std::shared_ptr<Client> client;
+			std::vector<std::shared_ptr<Client>> idleClients;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (stopping_) {
+					break;
+				}
+
+				if (!runQueue_.empty()) {
+					client = runQueue_.front();
+					runQueue_.pop_front();
+					client->queued = false;
+					client->running = true;
+				}
+				else {
+					idleClients = clients_;
+					for (const auto& idle : idleClients) {
+						++idle->probing;
+					}
+				}
+			}
+
+			if (!client) {
+				int timeoutMs = 0;
+				for (const auto& idle : idleClients) {
+					int clientTimeout = idle->getTimeout();
+					if (clientTimeout > 0) {
+						timeoutMs = (timeoutMs > 0) ? std::min(timeoutMs, clientTimeout) : clientTimeout;
+					}
+				}
+
+				std::unique_lock<std::mutex> lock(mutex_);
+				for (const auto& idle : idleClients) {
+					--idle->probing;
+				}
+				if (!idleClients.empty()) {
+					idleCondition_.notify_all();
+				}
+
+				auto ready = [this] {
+					return stopping_ || !runQueue_.empty();
+					};
+
+				if (timeoutMs > 0) {
+					if (!condition_.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+						for (const auto& idle : clients_) {
+							if (!idle->running) {
+								enqueue(idle);
+							}
+						}
+					}
+				}
+				else {
+					condition_.wait(lock, ready);
+				}
+				continue;
+			}
+
+			bool more = client->run();
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			client->running = false;
+			if (!client->detached && (more || client->rerun)) {
+				enqueue(client);
+			}
+			client->rerun = false;
+			idleCondition_.notify_all();
+		}
+	}
+
+} // namespace zlog
@@ -0,0 +1,92 @@
+#ifndef __ZLOG_POOL__
+#define __ZLOG_POOL__
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const size_t MAX_FORMAT_THREADS          = 64;
+	static const size_t DEFAULT_FORMAT_CHUNK_SIZE   = 64;
+	static const size_t DEFAULT_WORKER_POOL_THREADS = 2;
+
+	class ZLogFormatPool {
+	public:
+		ZLogFormatPool();
+		~ZLogFormatPool();
+
+		ZLogFormatPool(const ZLogFormatPool&) = delete;
+		ZLogFormatPool& operator=(const ZLogFormatPool&) = delete;
+
+		int start(size_t threadCount);
+		void stop();
+
+		void run(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& fn);
+
+		size_t getThreadCount() const;
+
+	private:
+		struct Job {
+			const std::function<void(size_t, size_t)>* fn;
+			size_t count;
+			size_t chunkSize;
+			std::atomic<size_t> next;
+			std::atomic<size_t> remaining;
+		};
+
+		void runWorker();
+		void runChunks(Job& job);
+
+	private:
+		std::vector<std::thread> threads_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::condition_variable doneCondition_;
+		std::shared_ptr<Job> job_;
+		uint64_t generation_;
+		bool stopping_;
+	};
+
+	class ZLogWorkerPool {
+	public:
+		struct Client;
+
+		explicit ZLogWorkerPool(size_t threadCount = DEFAULT_WORKER_POOL_THREADS);
+		~ZLogWorkerPool();
+
+		ZLogWorkerPool(const ZLogWorkerPool&) = delete;
+		ZLogWorkerPool& operator=(const ZLogWorkerPool&) = delete;
+
+		static ZLogWorkerPool& getShared();
+
+		std::shared_ptr<Client> attach(std::function<bool()> run, std::function<int()> getTimeout);
+		void detach(const std::shared_ptr<Client>& client);
+		void schedule(const std::shared_ptr<Client>& client);
+
+		size_t getThreadCount() const;
+
+	private:
+		void runWorker();
+		void enqueue(const std::shared_ptr<Client>& client);
+
+	private:
+		std::vector<std::thread> threads_;
+		mutable std::mutex mutex_;
+		std::condition_variable condition_;
+		std::condition_variable idleCondition_;
+		std::vector<std::shared_ptr<Client>> clients_;
+		std::deque<std::shared_ptr<Client>> runQueue_;
+		bool stopping_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_POOL__
@@ -0,0 +1,474 @@
+#include "zlogrotate.h"
+
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace zlog {
+
+	ZLogRotator::ZLogRotator()
+		: stopping_(false) {
+		retention_.maxFiles = 0;
+		retention_.maxAgeSeconds = 0;
+		retention_.maxTotalBytes = 0;
+	}
+
+	ZLogRotator::~ZLogRotator() {
+		stop();
+	}
+
+	void ZLogRotator::setErrorHandler(std::function<void(const std::string&)> handler) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		errorHandler_ = std::move(handler);
+	}
+
+	void ZLogRotator::setRetention(const ZLogRetention& retention) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		retention_ = retention;
+	}
+
+	int ZLogRotator::enqueue(ZLogRotateTask&& task) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stopping_) {
+			return -1;
+		}
+
+		queue_.push_back(std::move(task));
+		if (!worker_.joinable()) {
+			worker_ = std::thread(&ZLogRotator::runWorker, this);
+		}
+		condition_.notify_one();
+		return 0;
+	}
+
+	void ZLogRotator::stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		condition_.notify_one();
+
+		if (worker_.joinable()) {
+			worker_.join();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = false;
+	}
+
+	bool ZLogRotator::isPending(const std::string& filePath) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (activePath_ == filePath) {
+			return true;
+		}
+		for (const auto& task : queue_) {
+			if (task.filePath == filePath) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t ZLogRotator::getPendingCount() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return queue_.size() + (activePath_.empty() ? 0 : 1);
+	}
+
+	void ZLogRotator::runWorker() {
+		lowerThreadPriority();
+
+		while (true) {
+			ZLogRotateTask task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				activePath_.clear();
+				condition_.wait(lock, [this] {
+					return !queue_.empty() || stopping_;
+					});
+
+				if (queue_.empty()) {
+					break;
+				}
+
+				task = std::move(queue_.front());
+				queue_.pop_front();
+				activePath_ = task.filePath;
+			}
+
+			processTask(task);
+		}
+	}
+
+	void ZLogRotator::processTask(ZLogRotateTask& task) {
+		if (task.oldWriter) {
+			if (task.oldWriter->close() != 0) {
+				reportError("Failed to close log file " + task.filePath + ": " + task.oldWriter->getLastErrorString());
+			}
+			task.oldWriter.reset();
+		}
+
+		bool moved = (std::rename(task.filePath.c_str(), task.rotatedPath.c_str()) == 0);
+		if (!moved) {
+			if (!task.freshPath.empty() && copyFile(task.filePath, task.rotatedPath) == 0) {
+				moved = true;
+			}
+			else {
+				reportError("Failed to rotate log file " + task.filePath + " to " + task.rotatedPath);
+			}
+		}
+
+		if (!task.freshPath.empty()) {
+			if (!moved) {
+				reportError("Keeping log output in " + task.freshPath + " because " + task.filePath + " could not be rotated");
+			}
+			else if (std::rename(task.freshPath.c_str(), task.filePath.c_str()) != 0) {
+#ifdef _WIN32
+				std::remove(task.filePath.c_str());
+				if (std::rename(task.freshPath.c_str(), task.filePath.c_str()) != 0)
+#endif
+				reportError("Failed to move fresh log file " + task.freshPath + " to " + task.filePath);
+			}
+		}
+
+		if (moved && task.compression != COMPRESS_NONE) {
+			std::string compressedPath = task.rotatedPath + ZLogCompressor::getSuffix(task.compression);
+			if (ZLogCompressor::compressFile(task.compression, task.rotatedPath, compressedPath) != 0) {
+				reportError("Failed to compress rotated log file " + task.rotatedPath);
+			}
+		}
+
+		applyRetention(task.managedPaths);
+	}
+
+	std::vector<std::string> ZLogRotator::recoverFreshFiles(const std::vector<std::string>& filePaths) {
+		std::vector<std::string> errors;
+
+		for (const auto& filePath : filePaths) {
+			size_t pos = filePath.find_last_of("/\\");
+			std::string dir = (pos == std::string::npos) ? "." : filePath.substr(0, pos);
+			std::string name = (pos == std::string::npos) ? filePath : filePath.substr(pos + 1);
+			std::string prefix = name + ".";
+
+			std::vector<std::string> fileNames;
+			listFileNames(dir, fileNames);
+
+			std::vector<std::pair<unsigned long long, std::string>> leftovers;
+			for (const auto& fileName : fileNames) {
+				if (fileName.size() <= prefix.size() + ZLOG_FRESH_FILE_SUFFIX.size() ||
+					fileName.compare(0, prefix.size(), prefix) != 0 ||
+					fileName.compare(fileName.size() - ZLOG_FRESH_FILE_SUFFIX.size(), ZLOG_FRESH_FILE_SUFFIX.size(), ZLOG_FRESH_FILE_SUFFIX) != 0) {
+					continue;
+				}
+
+				std::string counter = fileName.substr(prefix.size(), fileName.size() - prefix.size() - ZLOG_FRESH_FILE_SUFFIX.size());
+				if (counter.empty() || counter.size() > 18 ||
+					!std::all_of(counter.begin(), counter.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+					continue;
+				}
+				leftovers.emplace_back(std::stoull(counter), dir + "/" + fileName);
+			}
+
+			std::sort(leftovers.begin(), leftovers.end());
+			for (const auto& leftover : leftovers) {
+				if (copyFile(leftover.second, filePath, true) != 0) {
+					errors.push_back("Failed to recover unrotated log file " + leftover.second + " into " + filePath);
+				}
+				else if (std::remove(leftover.second.c_str()) != 0) {
+					errors.push_back("Recovered " + leftover.second + " into " + filePath + " but failed to remove it");
+				}
+			}
+		}
+		return errors;
+	}
+
+	int ZLogRotator::copyFile(const std::string& srcPath, const std::string& dstPath, bool append) {
+		FILE* src = std::fopen(srcPath.c_str(), "rb");
+		if (src == nullptr) {
+			return -1;
+		}
+
+		FILE* dst = std::fopen(dstPath.c_str(), append ? "ab" : "wb");
+		if (dst == nullptr) {
+			std::fclose(src);
+			return -1;
+		}
+
+		std::vector<char> buffer(DEFAULT_COMPRESS_CHUNK_SIZE);
+		bool failed = false;
+		size_t bytes;
+		while ((bytes = std::fread(buffer.data(), 1, buffer.size(), src)) > 0) {
+			if (std::fwrite(buffer.data(), 1, bytes, dst) != bytes) {
+				failed = true;
+				break;
+			}
+		}
+
+		if (std::ferror(src) != 0) {
+			failed = true;
+		}
+		std::fclose(src);
+		if (std::fclose(dst) != 0) {
+			failed = true;
+		}
+
+		if (failed) {
+			if (!append) {
+				std::remove(dstPath.c_str());
+			}
+			return -1;
+		}
+		return 0;
+	}
+
+	void ZLogRotator::applyRetention(const std::vector<std::string>& managedPaths) {
+		ZLogRetention retention;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			retention = retention_;
+		}
+
+		if (retention.maxFiles == 0 && retention.maxAgeSeconds <= 0 && retention.maxTotalBytes == 0) {
+			return;
+		}
+
+		std::vector<std::pair<std::string, std::vector<std::string>>> dirs;
+		for (const auto& path : managedPaths) {
+			size_t pos = path.find_last_of("/\\");
+			std::string dir = (pos == std::string::npos) ? "." : path.substr(0, pos);
+			std::string name = (pos == std::string::npos) ? path : path.substr(pos + 1);
+
+			auto it = std::find_if(dirs.begin(), dirs.end(), [&dir](const std::pair<std::string, std::vector<std::string>>& entry) {
+				return entry.first == dir;
+				});
+			if (it == dirs.end()) {
+				dirs.emplace_back(dir, std::vector<std::string>());
+				it = dirs.end() - 1;
+			}
+			if (std::find(it->second.begin(), it->second.end(), name) == it->second.end()) {
+				it->second.push_back(name);
+			}
+		}
+
+		long long now = static_cast<long long>(std::time(nullptr));
+
+		for (const auto& dir : dirs) {
+			std::vector<RotatedFile> files;
+			listRotatedFiles(dir.first, dir.second, files);
+
+			std::sort(files.begin(), files.end(), [](const RotatedFile& a, const RotatedFile& b) {
+				return (a.mtime != b.mtime) ? a.mtime > b.mtime : a.path > b.path;
+				});
+
+			std::vector<size_t> counts(dir.second.size(), 0);
+			size_t totalBytes = 0;
+			bool overBudget = false;
+
+			for (const auto& file : files) {
+				bool remove = false;
+				if (retention.maxFiles > 0 && ++counts[file.owner] > retention.maxFiles) {
+					remove = true;
+				}
+				else if (retention.maxAgeSeconds > 0 && now - file.mtime > retention.maxAgeSeconds) {
+					remove = true;
+				}
+				else if (retention.maxTotalBytes > 0 && (overBudget || totalBytes + file.size > retention.maxTotalBytes)) {
+					overBudget = true;
+					remove = true;
+				}
+
+				if (remove) {
+					removeRotatedFile(file);
+				}
+				else {
+					totalBytes += file.size;
+				}
+			}
+		}
+	}
+
+	void ZLogRotator::listRotatedFiles(const std::string& dir, const std::vector<std::string>& names, std::vector<RotatedFile>& files) const {
+		auto match = [&names](const std::string& fileName, size_t& owner) {
+			if (std::find(names.begin(), names.end(), fileName) != names.end()) {
+				return false;
+			}
+			if (fileName.size() >= ZLOG_FRESH_FILE_SUFFIX.size() &&
+				fileName.compare(fileName.size() - ZLOG_FRESH_FILE_SUFFIX.size(), ZLOG_FRESH_FILE_SUFFIX.size(), ZLOG_FRESH_FILE_SUFFIX) == 0) {
+				return false;
+			}
+
+			for (size_t i = 0; i < names.size(); ++i) {
+				const std::string& name = names[i];
+				size_t dot = name.find_last_of('.');
+				std::string stem = (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+				std::string ext = (dot == std::string::npos || dot == 0) ? "" : name.substr(dot);
+
+				std::string prefix = stem + "_";
+				if (fileName.size() <= prefix.size() || fileName.compare(0, prefix.size(), prefix) != 0) {
+					continue;
+				}
+
+				std::string rest = fileName.substr(prefix.size());
+				const char* suffixes[] = { "", ".gz", ".zst" };
+				for (const char* suffix : suffixes) {
+					std::string tail = ext + suffix;
+					if (rest.size() > tail.size() && rest.compare(rest.size() - tail.size(), tail.size(), tail) == 0 &&
+						isRotatedStamp(rest.substr(0, rest.size() - tail.size()))) {
+						owner = i;
+						return true;
+					}
+				}
+			}
+			return false;
+			};
+
+#ifdef _WIN32
+		struct __finddata64_t data;
+		intptr_t handle = _findfirst64((dir + "\\*").c_str(), &data);
+		if (handle == -1) {
+			return;
+		}
+		do {
+			size_t owner = 0;
+			if (!(data.attrib & _A_SUBDIR) && match(data.name, owner)) {
+				RotatedFile file;
+				file.path = dir + "\\" + data.name;
+				file.size = static_cast<size_t>(data.size);
+				file.mtime = static_cast<long long>(data.time_write);
+				file.owner = owner;
+				files.push_back(file);
+			}
+		} while (_findnext64(handle, &data) == 0);
+		_findclose(handle);
+#else
+		DIR* handle = opendir(dir.c_str());
+		if (handle == nullptr) {
+			return;
+		}
+		struct dirent* entry;
+		while ((entry = readdir(handle)) != nullptr) {
+			size_t owner = 0;
+			if (!match(entry->d_name, owner)) {
+				continue;
+			}
+
+			std::string path = dir + "/" + entry->d_name;
+			struct stat st;
+			if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+				continue;
+			}
+
+			RotatedFile file;
+			file.path = path;
+			file.size = static_cast<size_t>(st.st_size);
+			file.mtime = static_cast<long long>(st.st_mtime);
+			file.owner = owner;
+			files.push_back(file);
+		}
+		closedir(handle);
+#endif
+	}
+
+	bool ZLogRotator::isRotatedStamp(const std::string& stamp) {
+		auto digits = [&stamp](size_t begin, size_t count) {
+			if (count == 0 || begin + count > stamp.size()) {
+				return false;
+			}
+			return std::all_of(stamp.begin() + begin, stamp.begin() + begin + count, [](char c) {
+				return c >= '0' && c <= '9';
+				});
+			};
+
+		size_t pos = 0;
+		if (digits(0, 8) && stamp.size() > 8 && stamp[8] == '_' && digits(9, 6) && stamp.size() > 15 && stamp[15] == '_' && digits(16, 3)) {
+			pos = 19;
+		}
+		else if (stamp.compare(0, 7, "backup_") == 0) {
+			pos = 7;
+			while (pos < stamp.size() && stamp[pos] >= '0' && stamp[pos] <= '9') {
+				++pos;
+			}
+			if (pos == 7 || pos >= stamp.size() || stamp[pos] != '_' || !digits(pos + 1, 3)) {
+				return false;
+			}
+			pos += 4;
+		}
+		else {
+			return false;
+		}
+
+		if (pos == stamp.size()) {
+			return true;
+		}
+		return stamp[pos] == '_' && digits(pos + 1, stamp.size() - pos - 1);
+	}
+
+	void ZLogRotator::listFileNames(const std::string& dir, std::vector<std::string>& names) {
+#ifdef _WIN32
+		struct __finddata64_t data;
+		intptr_t handle = _findfirst64((dir + "\\*").c_str(), &data);
+		if (handle == -1) {
+			return;
+		}
+		do {
+			if (!(data.attrib & _A_SUBDIR)) {
+				names.push_back(data.name);
+			}
+		} while (_findnext64(handle, &data) == 0);
+		_findclose(handle);
+#else
+		DIR* handle = opendir(dir.c_str());
+		if (handle == nullptr) {
+			return;
+		}
+		struct dirent* entry;
+		while ((entry = readdir(handle)) != nullptr) {
+			names.push_back(entry->d_name);
+		}
+		closedir(handle);
+#endif
+	}
+
+	void ZLogRotator::removeRotatedFile(const RotatedFile& file) {
+		if (std::remove(file.path.c_str()) != 0) {
+			reportError("Failed to remove expired log file " + file.path);
+		}
+	}
+
+	void ZLogRotator::reportError(const std::string& msg) {
+		std::function<void(const std::string&)> handler;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			handler = errorHandler_;
+		}
+		if (handler) {
+			handler(msg);
+		}
+	}
+
+	void ZLogRotator::lowerThreadPriority() {
+#if defined(__linux__)
+		pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+		setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19);
+#ifdef SYS_ioprio_set
+		const int ioprioWhoProcess = 1;
+		const int ioprioClassIdle = 3;
+		syscall(SYS_ioprio_set, ioprioWhoProcess, tid, ioprioClassIdle << 13);
+#endif
+#endif
+	}
+
+} // namespace zlog
@@ -0,0 +1,87 @@
+#ifndef __ZLOG_ROTATE__
+#define __ZLOG_ROTATE__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+
+#include "zlogfile.h"
+#include "zlogcompress.h"
+
+namespace zlog {
+
+	static const std::string ZLOG_FRESH_FILE_SUFFIX = ".next";
+
+	struct ZLogRetention {
+		size_t maxFiles;
+		int maxAgeSeconds;
+		size_t maxTotalBytes;
+	};
+
+	struct ZLogRotateTask {
+		std::string filePath;
+		std::string rotatedPath;
+		std::string freshPath;
+		std::unique_ptr<ZLogFileWriter> oldWriter;
+		ZLogCompression compression;
+		std::vector<std::string> managedPaths;
+	};
+
+	class ZLogRotator {
+	public:
+		ZLogRotator();
+		~ZLogRotator();
+
+		ZLogRotator(const ZLogRotator&) = delete;
+		ZLogRotator& operator=(const ZLogRotator&) = delete;
+
+		void setErrorHandler(std::function<void(const std::string&)> handler);
+		void setRetention(const ZLogRetention& retention);
+
+		int enqueue(ZLogRotateTask&& task);
+		void stop();
+
+		std::vector<std::string> recoverFreshFiles(const std::vector<std::string>& filePaths);
+
+		bool isPending(const std::string& filePath) const;
+		size_t getPendingCount() const;
+
+	private:
+		struct RotatedFile {
+			std::string path;
+			size_t size;
+			long long mtime;
+			size_t owner;
+		};
+
+		void runWorker();
+		void processTask(ZLogRotateTask& task);
+		int copyFile(const std::string& srcPath, const std::string& dstPath, bool append = false);
+		void applyRetention(const std::vector<std::string>& managedPaths);
+		void listRotatedFiles(const std::string& dir, const std::vector<std::string>& names, std::vector<RotatedFile>& files) const;
+		void removeRotatedFile(const RotatedFile& file);
+		void reportError(const std::string& msg);
+		static bool isRotatedStamp(const std::string& stamp);
+		static void listFileNames(const std::string& dir, std::vector<std::string>& names);
+		static void lowerThreadPriority();
+
+	private:
+		std::thread worker_;
+		mutable std::mutex mutex_;
+		std::condition_variable condition_;
+		std::deque<ZLogRotateTask> queue_;
+		std::string activePath_;
+		bool stopping_;
+		ZLogRetention retention_;
+		std::function<void(const std::string&)> errorHandler_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_ROTATE__
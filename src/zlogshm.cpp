@@ -0,0 +1,405 @@
+#include "zlogshm.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace zlog {
+
+	static const size_t ZLOG_SHM_HEADER_SIZE = 4096;
+	static const size_t ZLOG_SHM_MIN_CAPACITY = 64 * 1024;
+
+	static size_t alignRecord(size_t size) {
+		return (size + ZLOG_SHM_RECORD_ALIGN - 1) & ~(ZLOG_SHM_RECORD_ALIGN - 1);
+	}
+
+	static std::string getShmName(const std::string& name) {
+		return (!name.empty() && name[0] == '/') ? name : "/" + name;
+	}
+
+#ifndef _WIN32
+	static void futexWake(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+		(void)word;
+#endif
+	}
+
+	static void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+#if defined(__linux__)
+		struct timespec ts;
+		ts.tv_sec = timeoutMs / 1000;
+		ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeoutMs >= 0 ? &ts : nullptr, nullptr, 0);
+#else
+		if (word->load() == expected && timeoutMs != 0) {
+			usleep(1000);
+		}
+#endif
+	}
+#endif
+
+	ZLogShmWriter::ZLogShmWriter()
+		: header_(nullptr)
+		, data_(nullptr)
+		, mapSize_(0)
+		, fd_(-1)
+		, pendingWake_(false)
+		, lastError_(0) {
+	}
+
+	ZLogShmWriter::~ZLogShmWriter() {
+		close();
+	}
+
+	int ZLogShmWriter::open(const std::string& name, size_t capacity) {
+		close();
+
+#ifdef _WIN32
+		(void)name;
+		(void)capacity;
+		lastError_ = ENOTSUP;
+		return -1;
+#else
+		if (name.empty()) {
+			lastError_ = EINVAL;
+			return -1;
+		}
+
+		size_t ringSize = ZLOG_SHM_MIN_CAPACITY;
+		while (ringSize < capacity) {
+			ringSize <<= 1;
+		}
+
+		std::string shmName = getShmName(name);
+		int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0600);
+		if (fd < 0) {
+			lastError_ = errno;
+			return -1;
+		}
+
+		if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+			lastError_ = (errno == EWOULDBLOCK) ? EBUSY : errno;
+			::close(fd);
+			return -1;
+		}
+
+		size_t mapSize = ZLOG_SHM_HEADER_SIZE + ringSize;
+		struct stat st;
+		bool reuse = (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == mapSize);
+
+		if (!reuse && ftruncate(fd, static_cast<off_t>(mapSize)) != 0) {
+			lastError_ = errno;
+			::close(fd);
+			return -1;
+		}
+
+		void* addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED) {
+			lastError_ = errno;
+			::close(fd);
+			return -1;
+		}
+
+		header_ = static_cast<ZLogShmHeader*>(addr);
+		data_ = static_cast<char*>(addr) + ZLOG_SHM_HEADER_SIZE;
+		mapSize_ = mapSize;
+		fd_ = fd;
+		name_ = shmName;
+
+		if (!reuse || header_->magic != ZLOG_SHM_MAGIC || header_->version != ZLOG_SHM_VERSION || header_->capacity != ringSize) {
+			header_->magic = 0;
+			header_->version = ZLOG_SHM_VERSION;
+			header_->capacity = ringSize;
+			header_->writePos.store(0);
+			header_->readPos.store(0);
+			header_->droppedCount.store(0);
+			header_->wakeSeq.store(0);
+			header_->readerWaiting.store(0);
+			std::atomic_thread_fence(std::memory_order_release);
+			header_->magic = ZLOG_SHM_MAGIC;
+		}
+
+		lastError_ = 0;
+		return 0;
+#endif
+	}
+
+	void ZLogShmWriter::close() {
+#ifndef _WIN32
+		if (header_ != nullptr) {
+			pendingWake_ = true;
+			flush();
+			munmap(header_, mapSize_);
+		}
+		if (fd_ >= 0) {
+			shm_unlink(name_.c_str());
+			::close(fd_);
+		}
+#endif
+		fd_ = -1;
+		header_ = nullptr;
+		data_ = nullptr;
+		mapSize_ = 0;
+		pendingWake_ = false;
+	}
+
+	int ZLogShmWriter::write(const char* data, size_t size) {
+		if (header_ == nullptr) {
+			return -1;
+		}
+
+		size_t capacity = static_cast<size_t>(header_->capacity);
+		size_t need = alignRecord(sizeof(ZLogShmRecordHeader) + size);
+		if (need > capacity / 2) {
+			header_->droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return -1;
+		}
+
+		uint64_t writePos = header_->writePos.load(std::memory_order_relaxed);
+		uint64_t readPos = header_->readPos.load(std::memory_order_acquire);
+		size_t offset = static_cast<size_t>(writePos & (capacity - 1));
+		size_t contiguous = capacity - offset;
+		size_t total = (contiguous < need) ? need + contiguous : need;
+
+		if (capacity - static_cast<size_t>(writePos - readPos) < total) {
+			header_->droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return -1;
+		}
+
+		if (contiguous < need) {
+			ZLogShmRecordHeader padding;
+			padding.size = static_cast<uint32_t>(contiguous - sizeof(ZLogShmRecordHeader));
+			padding.flags = SHM_RECORD_PADDING;
+			std::memcpy(data_ + offset, &padding, sizeof(padding));
+			writePos += contiguous;
+			offset = 0;
+		}
+
+		ZLogShmRecordHeader record;
+		record.size = static_cast<uint32_t>(size);
+		record.flags = SHM_RECORD_DATA;
+		std::memcpy(data_ + offset, &record, sizeof(record));
+		std::memcpy(data_ + offset + sizeof(record), data, size);
+
+		header_->writePos.store(writePos + need);
+		pendingWake_ = true;
+		return 0;
+	}
+
+	int ZLogShmWriter::flush() {
+		if (header_ == nullptr || !pendingWake_) {
+			return 0;
+		}
+
+		pendingWake_ = false;
+#ifndef _WIN32
+		if (header_->readerWaiting.load() != 0) {
+			header_->wakeSeq.fetch_add(1);
+			futexWake(&header_->wakeSeq);
+		}
+#endif
+		return 0;
+	}
+
+	bool ZLogShmWriter::isOpen() const {
+		return header_ != nullptr;
+	}
+
+	const std::string& ZLogShmWriter::getName() const {
+		return name_;
+	}
+
+	size_t ZLogShmWriter::getDroppedCount() const {
+		return header_ ? static_cast<size_t>(header_->droppedCount.load(std::memory_order_relaxed)) : 0;
+	}
+
+	int ZLogShmWriter::getLastError() const {
+		return lastError_;
+	}
+
+	ZLogShmReader::ZLogShmReader()
+		: header_(nullptr)
+		, data_(nullptr)
+		, mapSize_(0)
+		, fd_(-1)
+		, nextPos_(0)
+		, lastError_(0) {
+	}
+
+	ZLogShmReader::~ZLogShmReader() {
+		close();
+	}
+
+	int ZLogShmReader::open(const std::string& name) {
+		close();
+
+#ifdef _WIN32
+		(void)name;
+		lastError_ = ENOTSUP;
+		return -1;
+#else
+		int fd = shm_open(getShmName(name).c_str(), O_RDWR, 0);
+		if (fd < 0) {
+			lastError_ = errno;
+			return -1;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= ZLOG_SHM_HEADER_SIZE) {
+			lastError_ = EINVAL;
+			::close(fd);
+			return -1;
+		}
+
+		size_t mapSize = static_cast<size_t>(st.st_size);
+		void* addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED) {
+			lastError_ = errno;
+			::close(fd);
+			return -1;
+		}
+
+		ZLogShmHeader* header = static_cast<ZLogShmHeader*>(addr);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (header->magic != ZLOG_SHM_MAGIC || header->version != ZLOG_SHM_VERSION ||
+			header->capacity + ZLOG_SHM_HEADER_SIZE != mapSize) {
+			lastError_ = EPROTO;
+			munmap(addr, mapSize);
+			::close(fd);
+			return -1;
+		}
+
+		header_ = header;
+		data_ = static_cast<char*>(addr) + ZLOG_SHM_HEADER_SIZE;
+		mapSize_ = mapSize;
+		fd_ = fd;
+		nextPos_ = header_->readPos.load(std::memory_order_acquire);
+		lastError_ = 0;
+		return 0;
+#endif
+	}
+
+	void ZLogShmReader::close() {
+#ifndef _WIN32
+		if (header_ != nullptr) {
+			munmap(header_, mapSize_);
+		}
+		if (fd_ >= 0) {
+			::close(fd_);
+		}
+#endif
+		fd_ = -1;
+		header_ = nullptr;
+		data_ = nullptr;
+		mapSize_ = 0;
+		nextPos_ = 0;
+	}
+
+	const char* ZLogShmReader::peek(size_t& size) {
+		if (header_ == nullptr) {
+			return nullptr;
+		}
+
+		size_t capacity = static_cast<size_t>(header_->capacity);
+		while (true) {
+			uint64_t writePos = header_->writePos.load(std::memory_order_acquire);
+			if (nextPos_ == writePos) {
+				return nullptr;
+			}
+
+			size_t offset = static_cast<size_t>(nextPos_ & (capacity - 1));
+			ZLogShmRecordHeader record;
+			std::memcpy(&record, data_ + offset, sizeof(record));
+
+			if (record.size > capacity - offset - sizeof(record)) {
+				nextPos_ = writePos;
+				header_->readPos.store(nextPos_, std::memory_order_release);
+				return nullptr;
+			}
+
+			if (record.flags == SHM_RECORD_PADDING) {
+				nextPos_ += sizeof(record) + record.size;
+				header_->readPos.store(nextPos_, std::memory_order_release);
+				continue;
+			}
+
+			size = record.size;
+			return data_ + offset + sizeof(record);
+		}
+	}
+
+	void ZLogShmReader::consume() {
+		size_t size = 0;
+		if (peek(size) == nullptr) {
+			return;
+		}
+
+		nextPos_ += alignRecord(sizeof(ZLogShmRecordHeader) + size);
+		header_->readPos.store(nextPos_, std::memory_order_release);
+	}
+
+	int ZLogShmReader::wait(int timeoutMs) {
+		if (header_ == nullptr) {
+			return -1;
+		}
+
+		if (header_->writePos.load() != nextPos_) {
+			return 1;
+		}
+
+#ifndef _WIN32
+		uint32_t seq = header_->wakeSeq.load();
+		header_->readerWaiting.store(1);
+		if (header_->writePos.load() == nextPos_) {
+			futexWait(&header_->wakeSeq, seq, timeoutMs);
+		}
+		header_->readerWaiting.store(0);
+#else
+		(void)timeoutMs;
+#endif
+
+		return (header_->writePos.load() != nextPos_) ? 1 : 0;
+	}
+
+	bool ZLogShmReader::isOpen() const {
+		return header_ != nullptr;
+	}
+
+	bool ZLogShmReader::isWriterActive() const {
+#ifdef _WIN32
+		return false;
+#else
+		if (fd_ < 0) {
+			return false;
+		}
+		if (flock(fd_, LOCK_SH | LOCK_NB) != 0) {
+			return errno == EWOULDBLOCK;
+		}
+		flock(fd_, LOCK_UN);
+		return false;
+#endif
+	}
+
+	size_t ZLogShmReader::getDroppedCount() const {
+		return header_ ? static_cast<size_t>(header_->droppedCount.load(std::memory_order_relaxed)) : 0;
+	}
+
+	int ZLogShmReader::getLastError() const {
+		return lastError_;
+	}
+
+} // namespace zlog
@@ -0,0 +1,97 @@
+#ifndef __ZLOG_SHM__
+#define __ZLOG_SHM__
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const size_t   DEFAULT_SHM_CAPACITY  = 4 * 1024 * 1024;
+	static const uint32_t ZLOG_SHM_MAGIC        = 0x5A4C5348;
+	static const uint32_t ZLOG_SHM_VERSION      = 1;
+	static const size_t   ZLOG_SHM_RECORD_ALIGN = 8;
+
+	struct ZLogShmHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t capacity;
+		alignas(64) std::atomic<uint64_t> writePos;
+		std::atomic<uint64_t> droppedCount;
+		std::atomic<uint32_t> wakeSeq;
+		std::atomic<uint32_t> readerWaiting;
+		alignas(64) std::atomic<uint64_t> readPos;
+	};
+
+	struct ZLogShmRecordHeader {
+		uint32_t size;
+		uint32_t flags;
+	};
+
+	enum ZLogShmRecordFlag {
+		SHM_RECORD_DATA    = 0,
+		SHM_RECORD_PADDING = 1
+	};
+
+	class ZLogShmWriter {
+	public:
+		ZLogShmWriter();
+		~ZLogShmWriter();
+
+		ZLogShmWriter(const ZLogShmWriter&) = delete;
+		ZLogShmWriter& operator=(const ZLogShmWriter&) = delete;
+
+		int open(const std::string& name, size_t capacity);
+		void close();
+
+		int write(const char* data, size_t size);
+		int flush();
+
+		bool isOpen() const;
+		const std::string& getName() const;
+		size_t getDroppedCount() const;
+		int getLastError() const;
+
+	private:
+		ZLogShmHeader* header_;
+		char* data_;
+		size_t mapSize_;
+		int fd_;
+		std::string name_;
+		bool pendingWake_;
+		int lastError_;
+	};
+
+	class ZLogShmReader {
+	public:
+		ZLogShmReader();
+		~ZLogShmReader();
+
+		ZLogShmReader(const ZLogShmReader&) = delete;
+		ZLogShmReader& operator=(const ZLogShmReader&) = delete;
+
+		int open(const std::string& name);
+		void close();
+
+		const char* peek(size_t& size);
+		void consume();
+		int wait(int timeoutMs);
+
+		bool isOpen() const;
+		bool isWriterActive() const;
+		size_t getDroppedCount() const;
+		int getLastError() const;
+
+	private:
+		ZLogShmHeader* header_;
+		char* data_;
+		size_t mapSize_;
+		int fd_;
+		uint64_t nextPos_;
+		int lastError_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_SHM__
@@ -0,0 +1,1073 @@
+#include "zlogsink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#define ZLOG_ISATTY(fd) (_isatty(fd) != 0)
+#define ZLOG_WRITE(fd, data, size) _write(fd, data, static_cast<unsigned int>(size))
+#else
+#include <unistd.h>
+#include <poll.h>
+#include <climits>
+#include <fcntl.h>
+#include <netdb.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#define ZLOG_ISATTY(fd) (isatty(fd) != 0)
+#define ZLOG_WRITE(fd, data, size) ::write(fd, data, size)
+#endif
+
+namespace zlog {
+
+	ZLogConsoleSink::ZLogConsoleSink()
+		: nonBlocking_(false)
+		, maxBacklog_(DEFAULT_CONSOLE_BACKLOG)
+		, droppedCount_(0) {
+
+		streams_[CONSOLE_STDOUT].fd = 1;
+		streams_[CONSOLE_STDERR].fd = 2;
+
+		for (auto& stream : streams_) {
+			stream.writeFd = stream.fd;
+			stream.tty = ZLOG_ISATTY(stream.fd);
+			stream.socket = false;
+			stream.buffer.reserve(DEFAULT_CONSOLE_BUFFER_SIZE);
+		}
+	}
+
+	ZLogConsoleSink::~ZLogConsoleSink() {
+		flush();
+		for (auto& stream : streams_) {
+			closeNonBlocking(stream);
+		}
+	}
+
+	int ZLogConsoleSink::setNonBlocking(bool enable, size_t maxBacklog) {
+#ifdef _WIN32
+		if (enable) {
+			return -1;
+		}
+#endif
+		if (enable && maxBacklog == 0) {
+			return -1;
+		}
+
+		nonBlocking_ = enable;
+		if (enable) {
+			maxBacklog_ = maxBacklog;
+		}
+		for (auto& stream : streams_) {
+			if (enable) {
+				openNonBlocking(stream);
+			}
+			else {
+				closeNonBlocking(stream);
+			}
+		}
+		return 0;
+	}
+
+	void ZLogConsoleSink::openNonBlocking(Stream& stream) {
+#ifndef _WIN32
+		if (stream.writeFd != stream.fd || stream.socket) {
+			return;
+		}
+
+		struct stat st;
+		if (::fstat(stream.fd, &st) != 0) {
+			return;
+		}
+		if (S_ISSOCK(st.st_mode)) {
+			stream.socket = true;
+			return;
+		}
+		if (!S_ISCHR(st.st_mode) && !S_ISFIFO(st.st_mode)) {
+			return;
+		}
+
+		std::string path;
+		if (stream.tty) {
+			const char* name = ::ttyname(stream.fd);
+			if (name != nullptr) {
+				path = name;
+			}
+		}
+		if (path.empty()) {
+			path = "/proc/self/fd/" + std::to_string(stream.fd);
+		}
+
+		int fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+		if (fd >= 0) {
+			struct stat reopened;
+			if (::fstat(fd, &reopened) == 0 && reopened.st_dev == st.st_dev && reopened.st_ino == st.st_ino) {
+				stream.writeFd = fd;
+			}
+			else {
+				::close(fd);
+			}
+		}
+#else
+		(void)stream;
+#endif
+	}
+
+	void ZLogConsoleSink::closeNonBlocking(Stream& stream) {
+#ifndef _WIN32
+		if (stream.writeFd != stream.fd) {
+			::close(stream.writeFd);
+		}
+#endif
+		stream.writeFd = stream.fd;
+		stream.socket = false;
+	}
+
+	int ZLogConsoleSink::write(ZLogConsoleStream stream, const char* data, size_t size) {
+		Stream& target = streams_[stream];
+
+		if (nonBlocking_ && target.buffer.size() + size > maxBacklog_) {
+			flushStream(target);
+			if (target.buffer.size() + size > maxBacklog_) {
+				droppedCount_.fetch_add(1);
+				return -1;
+			}
+		}
+
+		target.buffer.append(data, size);
+
+		if (target.buffer.size() >= DEFAULT_CONSOLE_BUFFER_SIZE) {
+			return flushStream(target);
+		}
+		return 0;
+	}
+
+	int ZLogConsoleSink::flush() {
+		int ret = 0;
+		for (auto& stream : streams_) {
+			if (flushStream(stream) != 0) {
+				ret = -1;
+			}
+		}
+		return ret;
+	}
+
+	bool ZLogConsoleSink::isTty(ZLogConsoleStream stream) const {
+		return streams_[stream].tty;
+	}
+
+	bool ZLogConsoleSink::isNonBlocking() const {
+		return nonBlocking_;
+	}
+
+	size_t ZLogConsoleSink::getBacklogSize() const {
+		return streams_[CONSOLE_STDOUT].buffer.size() + streams_[CONSOLE_STDERR].buffer.size();
+	}
+
+	size_t ZLogConsoleSink::getDroppedCount() const {
+		return droppedCount_.load();
+	}
+
+	int ZLogConsoleSink::flushStream(Stream& stream) {
+		size_t written = 0;
+
+		while (written < stream.buffer.size()) {
+			size_t chunk = stream.buffer.size() - written;
+
+#ifndef _WIN32
+			if (nonBlocking_ && stream.writeFd == stream.fd && !stream.socket) {
+				struct pollfd pfd;
+				pfd.fd = stream.fd;
+				pfd.events = POLLOUT;
+				pfd.revents = 0;
+
+				int ready = ::poll(&pfd, 1, 0);
+				if (ready < 0 && errno == EINTR) {
+					continue;
+				}
+				if (ready <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+					break;
+				}
+				if (chunk > PIPE_BUF) {
+					chunk = PIPE_BUF;
+				}
+			}
+#endif
+
+#ifndef _WIN32
+			auto n = (nonBlocking_ && stream.socket)
+				? ::send(stream.fd, stream.buffer.data() + written, chunk, MSG_DONTWAIT)
+				: ZLOG_WRITE(stream.writeFd, stream.buffer.data() + written, chunk);
+#else
+			auto n = ZLOG_WRITE(stream.writeFd, stream.buffer.data() + written, chunk);
+#endif
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+#ifndef _WIN32
+					if (!nonBlocking_) {
+						struct pollfd pfd;
+						pfd.fd = stream.fd;
+						pfd.events = POLLOUT;
+						pfd.revents = 0;
+						::poll(&pfd, 1, -1);
+						continue;
+					}
+#endif
+					break;
+				}
+				stream.buffer.clear();
+				return -1;
+			}
+			written += static_cast<size_t>(n);
+		}
+
+		stream.buffer.erase(0, written);
+		return 0;
+	}
+
+	ZLogSyslogSink::ZLogSyslogSink()
+		: fd_(-1)
+		, connected_(false)
+		, sentCount_(0)
+		, droppedCount_(0)
+		, lastError_(0) {
+		buffer_.reserve(DEFAULT_SYSLOG_BATCH_SIZE * 512);
+		frames_.reserve(DEFAULT_SYSLOG_BATCH_SIZE);
+	}
+
+	ZLogSyslogSink::~ZLogSyslogSink() {
+		close();
+	}
+
+	int ZLogSyslogSink::open(const std::string& target) {
+		close();
+
+#ifdef _WIN32
+		(void)target;
+		lastError_ = ENOTSUP;
+		return -1;
+#else
+		int family = AF_UNIX;
+		std::string path;
+		std::string host;
+		std::string port;
+
+		if (target.compare(0, 5, "unix:") == 0) {
+			path = target.substr(5);
+		}
+		else if (!target.empty() && target[0] == '/') {
+			path = target;
+		}
+		else if (target.compare(0, 4, "udp:") == 0) {
+			std::string hostPort = target.substr(4);
+			size_t pos = hostPort.find_last_of(':');
+			if (pos == std::string::npos) {
+				lastError_ = EINVAL;
+				return -1;
+			}
+			host = hostPort.substr(0, pos);
+			port = hostPort.substr(pos + 1);
+			if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+				host = host.substr(1, host.size() - 2);
+			}
+			family = AF_UNSPEC;
+		}
+		else {
+			lastError_ = EINVAL;
+			return -1;
+		}
+
+		if (family == AF_UNIX) {
+			struct sockaddr_un addr;
+			std::memset(&addr, 0, sizeof(addr));
+			if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+				lastError_ = ENAMETOOLONG;
+				return -1;
+			}
+			addr.sun_family = AF_UNIX;
+			std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+			address_.assign(reinterpret_cast<unsigned char*>(&addr), reinterpret_cast<unsigned char*>(&addr) + sizeof(addr));
+		}
+		else {
+			struct addrinfo hints;
+			std::memset(&hints, 0, sizeof(hints));
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_DGRAM;
+
+			struct addrinfo* result = nullptr;
+			if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+				lastError_ = EHOSTUNREACH;
+				return -1;
+			}
+
+			family = result->ai_family;
+			address_.assign(reinterpret_cast<unsigned char*>(result->ai_addr),
+				reinterpret_cast<unsigned char*>(result->ai_addr) + result->ai_addrlen);
+			freeaddrinfo(result);
+		}
+
+#if defined(SOCK_CLOEXEC) && defined(SOCK_NONBLOCK)
+		int fd = ::socket(family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+#else
+		int fd = ::socket(family, SOCK_DGRAM, 0);
+		if (fd >= 0) {
+			::fcntl(fd, F_SETFD, FD_CLOEXEC);
+			::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+		}
+#endif
+		if (fd < 0) {
+			lastError_ = errno;
+			return -1;
+		}
+
+		fd_ = fd;
+		target_ = target;
+		connectTarget();
+		lastError_ = 0;
+		return 0;
+#endif
+	}
+
+	void ZLogSyslogSink::close() {
+		if (fd_ < 0) {
+			return;
+		}
+
+		flush();
+#ifndef _WIN32
+		::close(fd_);
+#endif
+		fd_ = -1;
+		connected_ = false;
+	}
+
+	int ZLogSyslogSink::write(const char* data, size_t size) {
+		if (fd_ < 0) {
+			droppedCount_.fetch_add(1);
+			return -1;
+		}
+
+		if (size > DEFAULT_SYSLOG_MAX_FRAME) {
+			size = DEFAULT_SYSLOG_MAX_FRAME;
+		}
+
+		frames_.emplace_back(buffer_.size(), size);
+		buffer_.append(data, size);
+
+		if (frames_.size() >= DEFAULT_SYSLOG_BATCH_SIZE) {
+			return flush();
+		}
+		return 0;
+	}
+
+	int ZLogSyslogSink::flush() {
+		if (frames_.empty()) {
+			return 0;
+		}
+
+		int ret = 0;
+
+#ifndef _WIN32
+		if (!connected_) {
+			connectTarget();
+		}
+
+		const struct sockaddr* addr = connected_ ? nullptr : reinterpret_cast<const struct sockaddr*>(address_.data());
+		socklen_t addrLen = connected_ ? 0 : static_cast<socklen_t>(address_.size());
+		size_t sent = 0;
+		bool reconnected = false;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DEFAULT_SYSLOG_SEND_TIMEOUT_MS);
+
+#if defined(__linux__)
+		struct iovec iov[DEFAULT_SYSLOG_BATCH_SIZE];
+		struct mmsghdr msgs[DEFAULT_SYSLOG_BATCH_SIZE];
+
+		while (sent < frames_.size()) {
+			size_t count = std::min(frames_.size() - sent, DEFAULT_SYSLOG_BATCH_SIZE);
+			std::memset(msgs, 0, sizeof(struct mmsghdr) * count);
+
+			for (size_t i = 0; i < count; ++i) {
+				iov[i].iov_base = &buffer_[frames_[sent + i].first];
+				iov[i].iov_len = frames_[sent + i].second;
+				msgs[i].msg_hdr.msg_name = const_cast<struct sockaddr*>(addr);
+				msgs[i].msg_hdr.msg_namelen = addrLen;
+				msgs[i].msg_hdr.msg_iov = &iov[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int n = ::sendmmsg(fd_, msgs, static_cast<unsigned int>(count), 0);
+			if (n < 0) {
+				int error = errno;
+				if (error == EINTR) {
+					continue;
+				}
+				if (error == EAGAIN || error == EWOULDBLOCK) {
+					int remainingMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+						deadline - std::chrono::steady_clock::now()).count());
+					if (remainingMs > 0 && waitWritable(remainingMs)) {
+						continue;
+					}
+				}
+				else if (connected_ && !reconnected && (error == ECONNREFUSED || error == ENOTCONN)) {
+					reconnected = true;
+					if (connectTarget()) {
+						continue;
+					}
+				}
+				lastError_ = error;
+				ret = -1;
+				break;
+			}
+			sent += static_cast<size_t>(n);
+			sentCount_.fetch_add(static_cast<size_t>(n));
+		}
+#else
+		while (sent < frames_.size()) {
+			ssize_t n = ::sendto(fd_, &buffer_[frames_[sent].first], frames_[sent].second, 0, addr, addrLen);
+			if (n < 0) {
+				int error = errno;
+				if (error == EINTR) {
+					continue;
+				}
+				if (error == EAGAIN || error == EWOULDBLOCK) {
+					int remainingMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+						deadline - std::chrono::steady_clock::now()).count());
+					if (remainingMs > 0 && waitWritable(remainingMs)) {
+						continue;
+					}
+				}
+				else if (connected_ && !reconnected && (error == ECONNREFUSED || error == ENOTCONN)) {
+					reconnected = true;
+					if (connectTarget()) {
+						continue;
+					}
+				}
+				lastError_ = error;
+				ret = -1;
+				break;
+			}
+			++sent;
+			sentCount_.fetch_add(1);
+		}
+#endif
+
+		if (sent < frames_.size()) {
+			droppedCount_.fetch_add(frames_.size() - sent);
+		}
+#endif
+
+		buffer_.clear();
+		frames_.clear();
+		return ret;
+	}
+
+	bool ZLogSyslogSink::connectTarget() {
+#ifdef _WIN32
+		return false;
+#else
+		const struct sockaddr* addr = reinterpret_cast<const struct sockaddr*>(address_.data());
+		connected_ = ::connect(fd_, addr, static_cast<socklen_t>(address_.size())) == 0;
+		return connected_;
+#endif
+	}
+
+	bool ZLogSyslogSink::waitWritable(int timeoutMs) {
+#ifdef _WIN32
+		(void)timeoutMs;
+		return false;
+#else
+		struct pollfd pfd;
+		pfd.fd = fd_;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		return ::poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLOUT);
+#endif
+	}
+
+	bool ZLogSyslogSink::isOpen() const {
+		return fd_ >= 0;
+	}
+
+	const std::string& ZLogSyslogSink::getTarget() const {
+		return target_;
+	}
+
+	size_t ZLogSyslogSink::getSentCount() const {
+		return sentCount_.load();
+	}
+
+	size_t ZLogSyslogSink::getDroppedCount() const {
+		return droppedCount_.load();
+	}
+
+	int ZLogSyslogSink::getLastError() const {
+		return lastError_;
+	}
+
+	ZLogTcpSink::ZLogTcpSink()
+		: fd_(-1)
+		, connecting_(false)
+		, opened_(false)
+		, family_(AF_UNSPEC)
+		, nextConnectTime_(std::chrono::steady_clock::now())
+		, retryDelayMs_(DEFAULT_TCP_RETRY_MIN_MS)
+		, pendingSent_(0)
+		, spoolMaxSize_(DEFAULT_SPOOL_MAX_SIZE)
+		, spoolSize_(0)
+		, readOffset_(0)
+		, sentCount_(0)
+		, spooledCount_(0)
+		, droppedCount_(0) {
+	}
+
+	ZLogTcpSink::~ZLogTcpSink() {
+		close();
+	}
+
+	int ZLogTcpSink::open(const std::string& target, const std::string& spoolDir, size_t spoolMaxSize) {
+		close();
+
+#ifdef _WIN32
+		(void)target;
+		(void)spoolDir;
+		(void)spoolMaxSize;
+		return -1;
+#else
+		std::string hostPort = target;
+		if (hostPort.compare(0, 4, "tcp:") == 0) {
+			hostPort = hostPort.substr(4);
+		}
+
+		size_t pos = hostPort.find_last_of(':');
+		if (pos == std::string::npos || pos + 1 >= hostPort.size() || spoolMaxSize == 0) {
+			return -1;
+		}
+
+		host_ = hostPort.substr(0, pos);
+		port_ = hostPort.substr(pos + 1);
+		if (host_.size() >= 2 && host_.front() == '[' && host_.back() == ']') {
+			host_ = host_.substr(1, host_.size() - 2);
+		}
+
+		spoolDir_ = spoolDir;
+		spoolMaxSize_ = spoolMaxSize;
+		retryDelayMs_ = DEFAULT_TCP_RETRY_MIN_MS;
+		nextConnectTime_ = std::chrono::steady_clock::now();
+		address_.clear();
+		opened_ = true;
+
+		loadSpool();
+		resolvePeer();
+		connectPeer();
+		return 0;
+#endif
+	}
+
+	int ZLogTcpSink::close() {
+		if (!opened_) {
+			return 0;
+		}
+
+		flush();
+		disconnect();
+		int ret = persistSpool();
+
+		spoolWriter_.reset();
+		pending_.clear();
+		pendingSent_ = 0;
+		segments_.clear();
+		spoolSize_ = 0;
+		readOffset_ = 0;
+		opened_ = false;
+		return ret;
+	}
+
+	int ZLogTcpSink::write(const char* data, size_t size) {
+		if (!opened_) {
+			droppedCount_.fetch_add(1);
+			return -1;
+		}
+
+		char header[4];
+		header[0] = static_cast<char>((size >> 24) & 0xff);
+		header[1] = static_cast<char>((size >> 16) & 0xff);
+		header[2] = static_cast<char>((size >> 8) & 0xff);
+		header[3] = static_cast<char>(size & 0xff);
+
+		if (fd_ < 0 || connecting_ || !segments_.empty() || pending_.size() + size + 4 > DEFAULT_TCP_PENDING_SIZE) {
+			return spoolFrame(header, data, size);
+		}
+
+		pending_.append(header, 4);
+		pending_.append(data, size);
+		return 0;
+	}
+
+	int ZLogTcpSink::flush() {
+		if (!opened_) {
+			return 0;
+		}
+
+		if (fd_ < 0 || connecting_) {
+			connectPeer();
+		}
+
+		if (spoolWriter_) {
+			spoolWriter_->flush();
+		}
+
+		while (fd_ >= 0 && !connecting_) {
+			if (sendPending() != 0 || !pending_.empty()) {
+				break;
+			}
+			if (segments_.empty()) {
+				break;
+			}
+			replaySpool();
+		}
+
+		return (fd_ >= 0 && !connecting_) ? 0 : -1;
+	}
+
+	bool ZLogTcpSink::isOpen() const {
+		return opened_;
+	}
+
+	bool ZLogTcpSink::isConnected() const {
+		return fd_ >= 0 && !connecting_;
+	}
+
+	bool ZLogTcpSink::hasBacklog() const {
+		return opened_ && (!pending_.empty() || !segments_.empty());
+	}
+
+	size_t ZLogTcpSink::getSentCount() const {
+		return sentCount_.load();
+	}
+
+	size_t ZLogTcpSink::getSpooledCount() const {
+		return spooledCount_.load();
+	}
+
+	size_t ZLogTcpSink::getDroppedCount() const {
+		return droppedCount_.load();
+	}
+
+	size_t ZLogTcpSink::getSpoolSize() const {
+		return spoolSize_;
+	}
+
+	const std::string& ZLogTcpSink::getSpoolDirectory() const {
+		return spoolDir_;
+	}
+
+	bool ZLogTcpSink::resolvePeer() {
+#ifdef _WIN32
+		return false;
+#else
+		struct addrinfo hints;
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		struct addrinfo* result = nullptr;
+		if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &result) != 0 || result == nullptr) {
+			return false;
+		}
+
+		family_ = result->ai_family;
+		address_.assign(reinterpret_cast<unsigned char*>(result->ai_addr),
+			reinterpret_cast<unsigned char*>(result->ai_addr) + result->ai_addrlen);
+		freeaddrinfo(result);
+		return true;
+#endif
+	}
+
+	void ZLogTcpSink::connectPeer() {
+#ifndef _WIN32
+		if (connecting_) {
+			struct pollfd pfd;
+			pfd.fd = fd_;
+			pfd.events = POLLOUT;
+			pfd.revents = 0;
+			if (::poll(&pfd, 1, 0) == 0) {
+				return;
+			}
+
+			int error = 0;
+			socklen_t len = sizeof(error);
+			if (::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0) {
+				disconnect();
+				return;
+			}
+
+			connecting_ = false;
+			retryDelayMs_ = DEFAULT_TCP_RETRY_MIN_MS;
+			return;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (now < nextConnectTime_) {
+			return;
+		}
+
+		nextConnectTime_ = now + std::chrono::milliseconds(retryDelayMs_);
+		retryDelayMs_ = std::min(retryDelayMs_ * 2, DEFAULT_TCP_RETRY_MAX_MS);
+
+		if (address_.empty() && !resolvePeer()) {
+			return;
+		}
+
+		int fd = ::socket(family_, SOCK_STREAM, 0);
+		if (fd < 0) {
+			return;
+		}
+
+		::fcntl(fd, F_SETFD, FD_CLOEXEC);
+		::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+		int one = 1;
+		::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+		::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+		int ret = ::connect(fd, reinterpret_cast<const struct sockaddr*>(address_.data()), static_cast<socklen_t>(address_.size()));
+
+		if (ret != 0 && errno != EINPROGRESS) {
+			::close(fd);
+			return;
+		}
+
+		fd_ = fd;
+		connecting_ = (ret != 0);
+		if (!connecting_) {
+			retryDelayMs_ = DEFAULT_TCP_RETRY_MIN_MS;
+		}
+#endif
+	}
+
+	void ZLogTcpSink::disconnect() {
+		if (fd_ >= 0) {
+#ifndef _WIN32
+			::close(fd_);
+#endif
+			fd_ = -1;
+		}
+		connecting_ = false;
+
+		if (pendingSent_ > 0) {
+			size_t offset = 0;
+			while (offset + 4 <= pending_.size()) {
+				size_t next = offset + 4 + getFrameSize(pending_.data() + offset);
+				if (next > pendingSent_) {
+					break;
+				}
+				offset = next;
+			}
+			pending_.erase(0, offset);
+			pendingSent_ = 0;
+		}
+	}
+
+	int ZLogTcpSink::sendPending() {
+#ifdef _WIN32
+		return -1;
+#else
+		while (pendingSent_ < pending_.size()) {
+#ifdef MSG_NOSIGNAL
+			ssize_t n = ::send(fd_, pending_.data() + pendingSent_, pending_.size() - pendingSent_, MSG_NOSIGNAL);
+#else
+			ssize_t n = ::send(fd_, pending_.data() + pendingSent_, pending_.size() - pendingSent_, 0);
+#endif
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					return 0;
+				}
+				disconnect();
+				return -1;
+			}
+			pendingSent_ += static_cast<size_t>(n);
+		}
+
+		sentCount_.fetch_add(countFrames(pending_.data(), pending_.size()));
+
+		pending_.clear();
+		pendingSent_ = 0;
+		return 0;
+#endif
+	}
+
+	int ZLogTcpSink::spoolFrame(const char* header, const char* data, size_t size) {
+		size_t frameSize = size + 4;
+
+		while (spoolSize_ + frameSize > spoolMaxSize_ && segments_.size() > 1) {
+			dropOldestSegment();
+		}
+		if (spoolSize_ + frameSize > spoolMaxSize_) {
+			droppedCount_.fetch_add(1);
+			return -1;
+		}
+
+		if (segments_.empty() || segments_.back().size + frameSize > DEFAULT_SPOOL_SEGMENT_SIZE || !spoolWriter_ || !spoolWriter_->isOpen()) {
+			uint64_t index = segments_.empty() ? 0 : segments_.back().index + 1;
+			if (!spoolWriter_) {
+				spoolWriter_.reset(new ZLogFileWriter());
+			}
+			if (spoolWriter_->open(getSegmentPath(index), DEFAULT_CONSOLE_BUFFER_SIZE) != 0) {
+				droppedCount_.fetch_add(1);
+				return -1;
+			}
+			segments_.push_back(Segment{ index, 0, 0 });
+		}
+
+		if (spoolWriter_->write(header, 4) != 0 || spoolWriter_->write(data, size) != 0) {
+			droppedCount_.fetch_add(1);
+			return -1;
+		}
+
+		segments_.back().size += frameSize;
+		segments_.back().frames += 1;
+		spoolSize_ += frameSize;
+		spooledCount_.fetch_add(1);
+		return 0;
+	}
+
+	void ZLogTcpSink::replaySpool() {
+#ifndef _WIN32
+		while (!segments_.empty() && pending_.empty()) {
+			Segment& segment = segments_.front();
+			bool writing = (segments_.size() == 1) && spoolWriter_ && spoolWriter_->isOpen();
+
+			if (readOffset_ >= segment.size) {
+				if (writing) {
+					spoolWriter_->close();
+				}
+				removeSegment(segment);
+				segments_.erase(segments_.begin());
+				readOffset_ = 0;
+				continue;
+			}
+
+			int fd = ::open(getSegmentPath(segment.index).c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				droppedCount_.fetch_add(segment.frames);
+				removeSegment(segment);
+				segments_.erase(segments_.begin());
+				readOffset_ = 0;
+				continue;
+			}
+
+			size_t chunk = std::min(segment.size - readOffset_, DEFAULT_TCP_PENDING_SIZE);
+			size_t offset = 0;
+			size_t frames = 0;
+
+			for (int attempt = 0; attempt < 2 && offset == 0; ++attempt) {
+				pending_.resize(chunk);
+				ssize_t n = ::pread(fd, &pending_[0], chunk, static_cast<off_t>(readOffset_));
+				if (n <= 0) {
+					pending_.clear();
+					break;
+				}
+				pending_.resize(static_cast<size_t>(n));
+
+				while (offset + 4 <= pending_.size()) {
+					size_t next = offset + 4 + getFrameSize(pending_.data() + offset);
+					if (next > pending_.size()) {
+						if (offset == 0 && readOffset_ + next <= segment.size) {
+							chunk = next;
+						}
+						break;
+					}
+					offset = next;
+					++frames;
+				}
+			}
+			::close(fd);
+
+			if (pending_.empty()) {
+				segment.size = readOffset_;
+				continue;
+			}
+
+			if (offset == 0) {
+				droppedCount_.fetch_add(segment.frames);
+				pending_.clear();
+				readOffset_ = segment.size;
+				continue;
+			}
+
+			pending_.resize(offset);
+			readOffset_ += offset;
+			spoolSize_ -= std::min(spoolSize_, offset);
+			segment.frames -= std::min(segment.frames, frames);
+		}
+#endif
+	}
+
+	void ZLogTcpSink::loadSpool() {
+#ifndef _WIN32
+		segments_.clear();
+		spoolSize_ = 0;
+		readOffset_ = 0;
+
+		DIR* dir = ::opendir(spoolDir_.c_str());
+		if (dir == nullptr) {
+			return;
+		}
+
+		while (struct dirent* ent = ::readdir(dir)) {
+			unsigned long long index = 0;
+			char suffix[8] = { 0 };
+			if (std::sscanf(ent->d_name, "spool_%16llu.%4s", &index, suffix) != 2 || std::strcmp(suffix, "seg") != 0) {
+				continue;
+			}
+
+			struct stat st;
+			if (::stat(getSegmentPath(index).c_str(), &st) != 0 || st.st_size == 0) {
+				::unlink(getSegmentPath(index).c_str());
+				continue;
+			}
+
+			size_t size = static_cast<size_t>(st.st_size);
+			segments_.push_back(Segment{ index, size, countSegmentFrames(index, size) });
+			spoolSize_ += size;
+		}
+		::closedir(dir);
+
+		std::sort(segments_.begin(), segments_.end(), [](const Segment& a, const Segment& b) {
+			return a.index < b.index;
+			});
+#endif
+	}
+
+	int ZLogTcpSink::persistSpool() {
+#ifdef _WIN32
+		return 0;
+#else
+		int ret = 0;
+		if (spoolWriter_ && spoolWriter_->isOpen() && spoolWriter_->close() != 0) {
+			ret = -1;
+		}
+
+		if (pending_.empty() && readOffset_ == 0) {
+			return ret;
+		}
+
+		std::string head;
+		head.swap(pending_);
+		size_t pendingFrames = countFrames(head.data(), head.size());
+		uint64_t index = 0;
+
+		if (!segments_.empty()) {
+			Segment& front = segments_.front();
+			index = front.index;
+
+			int fd = ::open(getSegmentPath(index).c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd >= 0) {
+				size_t headSize = head.size();
+				head.resize(headSize + (front.size - readOffset_));
+				ssize_t n = ::pread(fd, &head[headSize], front.size - readOffset_, static_cast<off_t>(readOffset_));
+				head.resize(headSize + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+				::close(fd);
+			}
+		}
+
+		if (head.empty()) {
+			if (!segments_.empty()) {
+				removeSegment(segments_.front());
+			}
+			return ret;
+		}
+
+		std::string path = getSegmentPath(index);
+		std::string tempPath = path + ".tmp";
+		ZLogFileWriter writer;
+		if (writer.open(tempPath, 0) != 0 || writer.write(head.data(), head.size()) != 0 ||
+			writer.close() != 0 || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+			writer.close();
+			std::remove(tempPath.c_str());
+			droppedCount_.fetch_add(pendingFrames);
+			return -1;
+		}
+		return ret;
+#endif
+	}
+
+	size_t ZLogTcpSink::countSegmentFrames(uint64_t index, size_t size) const {
+		size_t frames = 0;
+#ifndef _WIN32
+		int fd = ::open(getSegmentPath(index).c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return 0;
+		}
+
+		std::vector<char> buffer(std::min(size, DEFAULT_TCP_PENDING_SIZE));
+		size_t offset = 0;
+		while (offset + 4 <= size) {
+			ssize_t n = ::pread(fd, buffer.data(), std::min(buffer.size(), size - offset), static_cast<off_t>(offset));
+			if (n < 4) {
+				break;
+			}
+
+			size_t position = 0;
+			while (position + 4 <= static_cast<size_t>(n) && offset + position < size) {
+				position += 4 + getFrameSize(buffer.data() + position);
+				++frames;
+			}
+			offset += position;
+		}
+		::close(fd);
+#else
+		(void)index;
+		(void)size;
+#endif
+		return frames;
+	}
+
+	size_t ZLogTcpSink::countFrames(const char* data, size_t size) {
+		size_t frames = 0;
+		for (size_t offset = 0; offset + 4 <= size; ++frames) {
+			offset += 4 + getFrameSize(data + offset);
+		}
+		return frames;
+	}
+
+	size_t ZLogTcpSink::getFrameSize(const char* header) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(header);
+		return (size_t(bytes[0]) << 24) | (size_t(bytes[1]) << 16) | (size_t(bytes[2]) << 8) | size_t(bytes[3]);
+	}
+
+	void ZLogTcpSink::dropOldestSegment() {
+		Segment& segment = segments_.front();
+		droppedCount_.fetch_add(segment.frames);
+		spoolSize_ -= std::min(spoolSize_, segment.size - readOffset_);
+		removeSegment(segment);
+		segments_.erase(segments_.begin());
+		readOffset_ = 0;
+	}
+
+	void ZLogTcpSink::removeSegment(const Segment& segment) {
+		std::remove(getSegmentPath(segment.index).c_str());
+	}
+
+	std::string ZLogTcpSink::getSegmentPath(uint64_t index) const {
+		char name[32];
+		std::snprintf(name, sizeof(name), "spool_%016llu.seg", static_cast<unsigned long long>(index));
+		return spoolDir_ + "/" + name;
+	}
+
+} // namespace zlog
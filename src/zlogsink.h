@@ -0,0 +1,193 @@
+#ifndef __ZLOG_SINK__
+#define __ZLOG_SINK__
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "zlogfile.h"
+
+namespace zlog {
+
+	static const size_t DEFAULT_CONSOLE_BUFFER_SIZE = 64 * 1024;
+	static const size_t DEFAULT_CONSOLE_BACKLOG     = 1024 * 1024;
+
+	static const std::string DEFAULT_SYSLOG_TARGET  = "unix:/dev/log";
+	static const int    DEFAULT_SYSLOG_FACILITY     = 1;
+	static const size_t DEFAULT_SYSLOG_BATCH_SIZE   = 64;
+	static const size_t DEFAULT_SYSLOG_MAX_FRAME    = 8 * 1024;
+	static const int    DEFAULT_SYSLOG_SEND_TIMEOUT_MS = 50;
+
+	static const size_t DEFAULT_TCP_PENDING_SIZE    = 1024 * 1024;
+	static const int    DEFAULT_TCP_RETRY_MIN_MS    = 100;
+	static const int    DEFAULT_TCP_RETRY_MAX_MS    = 30 * 1000;
+	static const size_t DEFAULT_SPOOL_MAX_SIZE      = 256 * 1024 * 1024;
+	static const size_t DEFAULT_SPOOL_SEGMENT_SIZE  = 16 * 1024 * 1024;
+	static const std::string DEFAULT_SPOOL_DIR      = "spool";
+
+	enum ZLogTcpFormat {
+		TCP_FORMAT_TEXT,
+		TCP_FORMAT_JSON
+	};
+
+	enum ZLogConsoleStream {
+		CONSOLE_STDOUT,
+		CONSOLE_STDERR,
+		CONSOLE_STREAM_COUNT
+	};
+
+	class ZLogConsoleSink {
+	public:
+		ZLogConsoleSink();
+		~ZLogConsoleSink();
+
+		ZLogConsoleSink(const ZLogConsoleSink&) = delete;
+		ZLogConsoleSink& operator=(const ZLogConsoleSink&) = delete;
+
+		int setNonBlocking(bool enable, size_t maxBacklog);
+
+		int write(ZLogConsoleStream stream, const char* data, size_t size);
+		int flush();
+
+		bool isTty(ZLogConsoleStream stream) const;
+		bool isNonBlocking() const;
+		size_t getBacklogSize() const;
+		size_t getDroppedCount() const;
+
+	private:
+		struct Stream {
+			int fd;
+			int writeFd;
+			bool tty;
+			bool socket;
+			std::string buffer;
+		};
+
+		void openNonBlocking(Stream& stream);
+		void closeNonBlocking(Stream& stream);
+		int flushStream(Stream& stream);
+
+	private:
+		Stream streams_[CONSOLE_STREAM_COUNT];
+		bool nonBlocking_;
+		size_t maxBacklog_;
+		std::atomic<size_t> droppedCount_;
+	};
+
+	class ZLogSyslogSink {
+	public:
+		ZLogSyslogSink();
+		~ZLogSyslogSink();
+
+		ZLogSyslogSink(const ZLogSyslogSink&) = delete;
+		ZLogSyslogSink& operator=(const ZLogSyslogSink&) = delete;
+
+		int open(const std::string& target);
+		void close();
+
+		int write(const char* data, size_t size);
+		int flush();
+
+		bool isOpen() const;
+		const std::string& getTarget() const;
+		size_t getSentCount() const;
+		size_t getDroppedCount() const;
+
+		int getLastError() const;
+
+	private:
+		bool connectTarget();
+		bool waitWritable(int timeoutMs);
+
+	private:
+		int fd_;
+		bool connected_;
+		std::string target_;
+		std::vector<unsigned char> address_;
+		std::string buffer_;
+		std::vector<std::pair<size_t, size_t>> frames_;
+		std::atomic<size_t> sentCount_;
+		std::atomic<size_t> droppedCount_;
+		int lastError_;
+	};
+
+	class ZLogTcpSink {
+	public:
+		ZLogTcpSink();
+		~ZLogTcpSink();
+
+		ZLogTcpSink(const ZLogTcpSink&) = delete;
+		ZLogTcpSink& operator=(const ZLogTcpSink&) = delete;
+
+		int open(const std::string& target, const std::string& spoolDir, size_t spoolMaxSize);
+		int close();
+
+		int write(const char* data, size_t size);
+		int flush();
+
+		bool isOpen() const;
+		bool isConnected() const;
+		bool hasBacklog() const;
+
+		size_t getSentCount() const;
+		size_t getSpooledCount() const;
+		size_t getDroppedCount() const;
+		size_t getSpoolSize() const;
+		const std::string& getSpoolDirectory() const;
+
+	private:
+		struct Segment {
+			uint64_t index;
+			size_t size;
+			size_t frames;
+		};
+
+		bool resolvePeer();
+		void connectPeer();
+		void disconnect();
+		int sendPending();
+		int spoolFrame(const char* header, const char* data, size_t size);
+		void replaySpool();
+		void loadSpool();
+		int persistSpool();
+		size_t countSegmentFrames(uint64_t index, size_t size) const;
+		static size_t countFrames(const char* data, size_t size);
+		static size_t getFrameSize(const char* header);
+		void dropOldestSegment();
+		void removeSegment(const Segment& segment);
+		std::string getSegmentPath(uint64_t index) const;
+
+	private:
+		int fd_;
+		bool connecting_;
+		bool opened_;
+		std::string host_;
+		std::string port_;
+		int family_;
+		std::vector<unsigned char> address_;
+		std::chrono::steady_clock::time_point nextConnectTime_;
+		int retryDelayMs_;
+
+		std::string pending_;
+		size_t pendingSent_;
+
+		std::string spoolDir_;
+		size_t spoolMaxSize_;
+		size_t spoolSize_;
+		std::vector<Segment> segments_;
+		std::unique_ptr<ZLogFileWriter> spoolWriter_;
+		size_t readOffset_;
+
+		std::atomic<size_t> sentCount_;
+		std::atomic<size_t> spooledCount_;
+		std::atomic<size_t> droppedCount_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_SINK__
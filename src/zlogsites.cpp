@@ -0,0 +1,230 @@
+#include "zlogsites.h"
+#include "zloglimit.h"
+
+#include <algorithm>
+
+namespace zlog {
+
+	ZLogSiteTable::ZLogSiteTable()
+		: shards_(new Shard[ZLOG_SITE_SHARDS])
+		, nextShard_(0)
+		, windowStart_(std::chrono::steady_clock::now()) {
+		for (size_t s = 0; s < ZLOG_SITE_SHARDS; ++s) {
+			Shard& shard = shards_[s];
+			for (auto& slot : shard.slots) {
+				slot.key.store(0, std::memory_order_relaxed);
+				slot.messages.store(0, std::memory_order_relaxed);
+				slot.bytes.store(0, std::memory_order_relaxed);
+			}
+			for (auto& row : shard.sketch) {
+				for (auto& counter : row) {
+					counter.store(0, std::memory_order_relaxed);
+				}
+			}
+			shard.untracked.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void ZLogSiteTable::record(const std::string& file, int line, const std::string& message) {
+		Shard& shard = getShard();
+		uint64_t key = getSiteKey(file, line);
+
+		size_t index = static_cast<size_t>(key % ZLOG_SITE_SLOTS);
+		for (size_t probe = 0; probe < ZLOG_SITE_SLOTS; ++probe) {
+			Slot& slot = shard.slots[(index + probe) % ZLOG_SITE_SLOTS];
+			uint64_t current = slot.key.load(std::memory_order_acquire);
+
+			if (current == 0) {
+				if (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+					registerSite(key, file, line);
+					current = key;
+				}
+			}
+
+			if (current == key) {
+				slot.messages.fetch_add(1, std::memory_order_relaxed);
+				slot.bytes.fetch_add(message.size(), std::memory_order_relaxed);
+				break;
+			}
+
+			if (probe + 1 == ZLOG_SITE_SLOTS) {
+				shard.untracked.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		uint64_t hash = hashTemplate(message);
+		uint32_t local = addToSketch(shard, hash);
+		if (local >= ZLOG_TEMPLATE_MIN_COUNT && (local & (local - 1)) == 0) {
+			offerCandidate(hash, message);
+		}
+	}
+
+	ZLogSiteReport ZLogSiteTable::report(size_t count) {
+		std::map<uint64_t, std::pair<uint64_t, uint64_t>> totals;
+		uint64_t untracked = 0;
+
+		for (size_t s = 0; s < ZLOG_SITE_SHARDS; ++s) {
+			Shard& shard = shards_[s];
+			for (const auto& slot : shard.slots) {
+				uint64_t key = slot.key.load(std::memory_order_acquire);
+				if (key == 0) {
+					continue;
+				}
+				auto& total = totals[key];
+				total.first += slot.messages.load(std::memory_order_relaxed);
+				total.second += slot.bytes.load(std::memory_order_relaxed);
+			}
+			untracked += shard.untracked.exchange(0, std::memory_order_relaxed);
+		}
+
+		ZLogSiteReport result;
+		result.untracked = untracked;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto now = std::chrono::steady_clock::now();
+		result.windowSeconds = std::chrono::duration<double>(now - windowStart_).count();
+		windowStart_ = now;
+
+		for (const auto& total : totals) {
+			const auto& previous = baseline_[total.first];
+			uint64_t messages = total.second.first - previous.first;
+			uint64_t bytes = total.second.second - previous.second;
+			result.messages += messages;
+			result.bytes += bytes;
+
+			if (messages == 0) {
+				continue;
+			}
+
+			ZLogSiteStats stats;
+			auto name = names_.find(total.first);
+			stats.file = (name != names_.end()) ? name->second.first : std::string("?");
+			stats.line = (name != names_.end()) ? name->second.second : 0;
+			stats.messages = messages;
+			stats.bytes = bytes;
+			result.sites.push_back(std::move(stats));
+		}
+		baseline_ = std::move(totals);
+
+		std::sort(result.sites.begin(), result.sites.end(), [](const ZLogSiteStats& a, const ZLogSiteStats& b) {
+			return a.bytes != b.bytes ? a.bytes > b.bytes : a.messages > b.messages;
+			});
+		if (result.sites.size() > count) {
+			result.sites.resize(count);
+		}
+
+		for (const auto& candidate : candidates_) {
+			ZLogTemplateStats stats;
+			stats.sample = candidate.sample;
+			stats.estimate = estimate(candidate.hash);
+			result.templates.push_back(std::move(stats));
+		}
+		candidates_.clear();
+
+		std::sort(result.templates.begin(), result.templates.end(), [](const ZLogTemplateStats& a, const ZLogTemplateStats& b) {
+			return a.estimate > b.estimate;
+			});
+		if (result.templates.size() > count) {
+			result.templates.resize(count);
+		}
+
+		for (size_t s = 0; s < ZLOG_SITE_SHARDS; ++s) {
+			for (auto& row : shards_[s].sketch) {
+				for (auto& counter : row) {
+					counter.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	ZLogSiteTable::Shard& ZLogSiteTable::getShard() {
+		thread_local size_t shardIndex = nextShard_.fetch_add(1, std::memory_order_relaxed);
+		return shards_[shardIndex % ZLOG_SITE_SHARDS];
+	}
+
+	void ZLogSiteTable::registerSite(uint64_t key, const std::string& file, int line) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		names_.emplace(key, std::make_pair(file, line));
+	}
+
+	uint32_t ZLogSiteTable::addToSketch(Shard& shard, uint64_t hash) {
+		uint32_t minimum = UINT32_MAX;
+		for (size_t row = 0; row < ZLOG_SKETCH_DEPTH; ++row) {
+			uint32_t value = shard.sketch[row][getSketchIndex(hash, row)].fetch_add(1, std::memory_order_relaxed) + 1;
+			minimum = std::min(minimum, value);
+		}
+		return minimum;
+	}
+
+	uint64_t ZLogSiteTable::estimate(uint64_t hash) const {
+		uint64_t minimum = UINT64_MAX;
+		for (size_t row = 0; row < ZLOG_SKETCH_DEPTH; ++row) {
+			uint64_t total = 0;
+			size_t index = getSketchIndex(hash, row);
+			for (size_t s = 0; s < ZLOG_SITE_SHARDS; ++s) {
+				total += shards_[s].sketch[row][index].load(std::memory_order_relaxed);
+			}
+			minimum = std::min(minimum, total);
+		}
+		return minimum;
+	}
+
+	void ZLogSiteTable::offerCandidate(uint64_t hash, const std::string& message) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const auto& candidate : candidates_) {
+			if (candidate.hash == hash) {
+				return;
+			}
+		}
+
+		Candidate candidate;
+		candidate.hash = hash;
+		candidate.sample = message.substr(0, ZLOG_TEMPLATE_SAMPLE_SIZE);
+
+		if (candidates_.size() < ZLOG_TOP_TEMPLATES) {
+			candidates_.push_back(std::move(candidate));
+			return;
+		}
+
+		size_t weakest = 0;
+		uint64_t weakestEstimate = UINT64_MAX;
+		for (size_t i = 0; i < candidates_.size(); ++i) {
+			uint64_t value = estimate(candidates_[i].hash);
+			if (value < weakestEstimate) {
+				weakestEstimate = value;
+				weakest = i;
+			}
+		}
+		if (estimate(hash) > weakestEstimate) {
+			candidates_[weakest] = std::move(candidate);
+		}
+	}
+
+	uint64_t ZLogSiteTable::getSiteKey(const std::string& file, int line) {
+		uint64_t key = hashMessage(file) ^ (static_cast<uint64_t>(line) * 0x9E3779B97F4A7C15ULL);
+		return key != 0 ? key : 1;
+	}
+
+	uint64_t ZLogSiteTable::hashTemplate(const std::string& message) {
+		uint64_t hash = 14695981039346656037ULL;
+		bool inNumber = false;
+		for (unsigned char c : message) {
+			bool digit = (c >= '0' && c <= '9');
+			if (digit && inNumber) {
+				continue;
+			}
+			inNumber = digit;
+			hash ^= digit ? '#' : c;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	size_t ZLogSiteTable::getSketchIndex(uint64_t hash, size_t row) {
+		uint64_t mixed = (hash + row * 0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL;
+		return static_cast<size_t>((mixed ^ (mixed >> 31)) % ZLOG_SKETCH_WIDTH);
+	}
+
+} // namespace zlog
@@ -0,0 +1,99 @@
+#ifndef __ZLOG_SITES__
+#define __ZLOG_SITES__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace zlog {
+
+	static const size_t ZLOG_SITE_SHARDS          = 8;
+	static const size_t ZLOG_SITE_SLOTS           = 1024;
+	static const size_t ZLOG_SKETCH_DEPTH         = 4;
+	static const size_t ZLOG_SKETCH_WIDTH         = 1024;
+	static const size_t ZLOG_TOP_TEMPLATES        = 32;
+	static const size_t ZLOG_TEMPLATE_SAMPLE_SIZE = 120;
+	static const uint32_t ZLOG_TEMPLATE_MIN_COUNT = 64;
+
+	struct ZLogSiteStats {
+		std::string file;
+		int line;
+		uint64_t messages;
+		uint64_t bytes;
+	};
+
+	struct ZLogTemplateStats {
+		std::string sample;
+		uint64_t estimate;
+	};
+
+	struct ZLogSiteReport {
+		double windowSeconds;
+		uint64_t messages;
+		uint64_t bytes;
+		uint64_t untracked;
+		std::vector<ZLogSiteStats> sites;
+		std::vector<ZLogTemplateStats> templates;
+
+		ZLogSiteReport() : windowSeconds(0), messages(0), bytes(0), untracked(0) {}
+	};
+
+	class ZLogSiteTable {
+	public:
+		ZLogSiteTable();
+
+		ZLogSiteTable(const ZLogSiteTable&) = delete;
+		ZLogSiteTable& operator=(const ZLogSiteTable&) = delete;
+
+		void record(const std::string& file, int line, const std::string& message);
+
+		ZLogSiteReport report(size_t count);
+
+	private:
+		struct Slot {
+			std::atomic<uint64_t> key;
+			std::atomic<uint64_t> messages;
+			std::atomic<uint64_t> bytes;
+		};
+
+		struct Shard {
+			Slot slots[ZLOG_SITE_SLOTS];
+			std::atomic<uint32_t> sketch[ZLOG_SKETCH_DEPTH][ZLOG_SKETCH_WIDTH];
+			std::atomic<uint64_t> untracked;
+		};
+
+		struct Candidate {
+			uint64_t hash;
+			std::string sample;
+		};
+
+		Shard& getShard();
+		void registerSite(uint64_t key, const std::string& file, int line);
+		uint32_t addToSketch(Shard& shard, uint64_t hash);
+		uint64_t estimate(uint64_t hash) const;
+		void offerCandidate(uint64_t hash, const std::string& message);
+
+		static uint64_t getSiteKey(const std::string& file, int line);
+		static uint64_t hashTemplate(const std::string& message);
+		static size_t getSketchIndex(uint64_t hash, size_t row);
+
+	private:
+		std::unique_ptr<Shard[]> shards_;
+		std::atomic<size_t> nextShard_;
+
+		std::mutex mutex_;
+		std::map<uint64_t, std::pair<std::string, int>> names_;
+		std::map<uint64_t, std::pair<uint64_t, uint64_t>> baseline_;
+		std::vector<Candidate> candidates_;
+		std::chrono::steady_clock::time_point windowStart_;
+	};
+
+} // namespace zlog
+
+#endif // ! __ZLOG_SITES__
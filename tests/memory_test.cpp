@@ -0,0 +1,210 @@
+/**
+ * ZLogging 内存输出测试
+ *
+ * 检查 MEMORY_OUT 查询的级别、时间范围、子串和条数过滤，
+ * 以及环形缓冲区按条数和字节数淘汰最旧记录的边界。
+ *
+ * 用法：zlog_memory_test（全部通过返回 0）
+ */
+
+#include "zlogging.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+static bool contains(const zlog::ZLogMemoryRecord& record, const std::string& text) {
+    return record.text.find(text) != std::string::npos;
+}
+
+static void testRecordBound() {
+    zlog::ZLogMemorySink sink;
+    CHECK(sink.open(0, 0) != 0);
+    CHECK(sink.open(5, 0) == 0);
+    CHECK(sink.open(5, 0) != 0);
+
+    auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < 8; ++i) {
+        std::string text = "record " + std::to_string(i);
+        CHECK(sink.write(zlog::ZLOG_INFO, now, text.data(), text.size()) == 0);
+    }
+
+    // 只保留最新的5条，按写入顺序返回
+    CHECK(sink.getRecordCount() == 5);
+    CHECK(sink.getEvictedCount() == 3);
+    std::vector<zlog::ZLogMemoryRecord> records = sink.query(zlog::ZLogMemoryQuery());
+    CHECK(records.size() == 5);
+    for (size_t i = 0; i < records.size(); ++i) {
+        CHECK(records[i].index == i + 3);
+        CHECK(records[i].text == "record " + std::to_string(i + 3));
+    }
+
+    sink.clear();
+    CHECK(sink.getRecordCount() == 0);
+    CHECK(sink.getByteSize() == 0);
+    CHECK(sink.query(zlog::ZLogMemoryQuery()).empty());
+}
+
+static void testByteBound() {
+    zlog::ZLogMemorySink sink;
+    CHECK(sink.open(100, 50) == 0);
+
+    auto now = std::chrono::system_clock::now();
+    std::string text(10, 'x');
+    for (int i = 0; i < 10; ++i) {
+        CHECK(sink.write(zlog::ZLOG_INFO, now, text.data(), text.size()) == 0);
+    }
+
+    // 字节上限50，每条10字节，恰好保留5条
+    CHECK(sink.getByteSize() == 50);
+    CHECK(sink.getRecordCount() == 5);
+    CHECK(sink.getEvictedCount() == 5);
+
+    // 单条超过上限时淘汰其余记录，但保留最新这一条
+    std::string large(80, 'y');
+    CHECK(sink.write(zlog::ZLOG_INFO, now, large.data(), large.size()) == 0);
+    CHECK(sink.getRecordCount() == 1);
+    CHECK(sink.getByteSize() == 80);
+    std::vector<zlog::ZLogMemoryRecord> records = sink.query(zlog::ZLogMemoryQuery());
+    CHECK(records.size() == 1 && records[0].text == large);
+
+    // 再写入一条小记录后超大记录被淘汰
+    CHECK(sink.write(zlog::ZLOG_INFO, now, text.data(), text.size()) == 0);
+    CHECK(sink.getRecordCount() == 1);
+    CHECK(sink.getByteSize() == 10);
+}
+
+static void testTimeRange() {
+    zlog::ZLogMemorySink sink;
+    CHECK(sink.open(10, 0) == 0);
+
+    auto base = std::chrono::system_clock::now();
+    for (int i = 0; i < 3; ++i) {
+        std::string text = "at " + std::to_string(i);
+        sink.write(zlog::ZLOG_INFO, base + std::chrono::seconds(i), text.data(), text.size());
+    }
+
+    // 时间范围两端都包含在内
+    zlog::ZLogMemoryQuery query;
+    query.begin = base + std::chrono::seconds(1);
+    query.end = base + std::chrono::seconds(1);
+    std::vector<zlog::ZLogMemoryRecord> records = sink.query(query);
+    CHECK(records.size() == 1 && records[0].text == "at 1");
+
+    query.begin = base + std::chrono::seconds(1);
+    query.end = zlog::ZLogMemoryQuery().end;
+    records = sink.query(query);
+    CHECK(records.size() == 2 && records[0].text == "at 1" && records[1].text == "at 2");
+
+    query.begin = base + std::chrono::seconds(3);
+    CHECK(sink.query(query).empty());
+}
+
+static void testLoggerQuery() {
+    zlog::ZLogging logger("memory-query");
+    logger.setMemoryTarget(100);
+    logger.setMinLevel(zlog::ZLOG_DEBUG);
+    logger.setOutputMode(zlog::MEMORY_OUT, false, std::string());
+    CHECK(logger.initialize() == 0);
+
+    // 清除初始化时输出的 DEBUG 日志
+    CHECK(logger.flush() == 0);
+    logger.clearMemory();
+
+    auto start = std::chrono::system_clock::now();
+    logger.logDirect(zlog::ZLOG_DEBUG, "alpha", __FILE__, __FUNCTION__, __LINE__);
+    logger.logDirect(zlog::ZLOG_INFO, "beta timeout", __FILE__, __FUNCTION__, __LINE__);
+    logger.logDirect(zlog::ZLOG_WARNING, "gamma timeout", __FILE__, __FUNCTION__, __LINE__);
+    logger.logDirect(zlog::ZLOG_ERROR, "delta", __FILE__, __FUNCTION__, __LINE__);
+    CHECK(logger.flush() == 0);
+    auto stop = std::chrono::system_clock::now();
+
+    std::vector<zlog::ZLogMemoryRecord> records = logger.queryMemory();
+    CHECK(records.size() == 4);
+    CHECK(logger.getMemoryRecordCount() == 4);
+
+    // 级别过滤
+    zlog::ZLogMemoryQuery query;
+    query.minLevel = zlog::ZLOG_WARNING;
+    records = logger.queryMemory(query);
+    CHECK(records.size() == 2);
+    CHECK(records.size() == 2 && contains(records[0], "gamma timeout") && contains(records[1], "delta"));
+    CHECK(records.size() == 2 && records[0].level == zlog::ZLOG_WARNING && contains(records[0], "[WARNING]"));
+
+    // 子串过滤
+    query = zlog::ZLogMemoryQuery();
+    query.contains = "timeout";
+    records = logger.queryMemory(query);
+    CHECK(records.size() == 2 && contains(records[0], "beta") && contains(records[1], "gamma"));
+
+    // 级别与子串同时生效
+    query.minLevel = zlog::ZLOG_WARNING;
+    records = logger.queryMemory(query);
+    CHECK(records.size() == 1 && contains(records[0], "gamma"));
+
+    // 条数限制返回最新的记录
+    query = zlog::ZLogMemoryQuery();
+    query.limit = 2;
+    records = logger.queryMemory(query);
+    CHECK(records.size() == 2 && contains(records[0], "gamma") && contains(records[1], "delta"));
+
+    // 时间范围
+    query = zlog::ZLogMemoryQuery();
+    query.begin = start;
+    query.end = stop;
+    CHECK(logger.queryMemory(query).size() == 4);
+    query.begin = stop + std::chrono::seconds(1);
+    query.end = zlog::ZLogMemoryQuery().end;
+    CHECK(logger.queryMemory(query).empty());
+    query.begin = zlog::ZLogMemoryQuery().begin;
+    query.end = start - std::chrono::seconds(1);
+    CHECK(logger.queryMemory(query).empty());
+
+    logger.clearMemory();
+    CHECK(logger.getMemoryRecordCount() == 0);
+    CHECK(logger.queryMemory().empty());
+    logger.shutdown();
+}
+
+static void testLoggerEviction() {
+    zlog::ZLogging logger("memory-evict");
+    logger.setMemoryTarget(3);
+    logger.setOutputMode(zlog::MEMORY_OUT, false, std::string());
+    CHECK(logger.initialize() == 0);
+
+    for (int i = 0; i < 5; ++i) {
+        logger.logDirect(zlog::ZLOG_INFO, "line " + std::to_string(i), __FILE__, __FUNCTION__, __LINE__);
+    }
+    CHECK(logger.flush() == 0);
+
+    CHECK(logger.getMemoryRecordCount() == 3);
+    CHECK(logger.getMemoryEvictedCount() == 2);
+    std::vector<zlog::ZLogMemoryRecord> records = logger.queryMemory();
+    CHECK(records.size() == 3 && contains(records[0], "line 2") && contains(records[2], "line 4"));
+    logger.shutdown();
+}
+
+int main() {
+    testRecordBound();
+    testByteBound();
+    testTimeRange();
+    testLoggerQuery();
+    testLoggerEviction();
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("memory tests passed\n");
+    return 0;
+}
@@ -11,6 +11,9 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
  // 测试参数
@@ -304,6 +307,223 @@ void stressTest() {
     std::cout << "压力测试完成" << std::endl;
 }
 
+//==============================================================================
+// 6. 按大小轮转检查开销测试
+//==============================================================================
+
+void sizeRotateCheckTest() {
+    std::cout << "\n=== 按大小轮转检查开销测试 ===" << std::endl;
+
+    const int rotateTestCount = 50000;
+
+    // 文件大小在内存中跟踪，轮转检查不再每条调用 stat
+    ZLOG_SET_OUTPUT_MODE(ZLOG_FILE_ONLY, false, "");
+    ZLOG_SET_MAX_LOG_SIZE(1024UL * 1024 * 1024);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ZLOG_SET_ROTATE_POLICY(NO_ROTATE);
+    {
+        ZLOG_TIMER("不轮转");
+        for (int i = 0; i < rotateTestCount; ++i) {
+            ZINFO() << "轮转检查测试 " << i;
+        }
+        ZLOG_FLUSH();
+    }
+
+    ZLOG_SET_ROTATE_POLICY(SIZE_ROTATE);
+    {
+        ZLOG_TIMER("按大小轮转（ALWAYS_OPEN）");
+        for (int i = 0; i < rotateTestCount; ++i) {
+            ZINFO() << "轮转检查测试 " << i;
+        }
+        ZLOG_FLUSH();
+    }
+
+    ZLOG_SET_ROTATE_POLICY(NO_ROTATE);
+    ZLOG_SET_OUTPUT_MODE(ZLOG_DEFAULT_MODE, false, "");
+    std::cout << "按大小轮转检查开销测试完成" << std::endl;
+}
+
+//==============================================================================
+// 7. 同步写入级别开销测试
+//==============================================================================
+
+void synchronousLevelTest() {
+    std::cout << "\n=== 同步写入级别开销测试 ===" << std::endl;
+
+    const int syncTestCount = 5000;
+
+    // 同步级别在调用线程上先写出队列中已有的日志，再格式化并写入本条日志
+    ZLOG_SET_OUTPUT_MODE(ZLOG_FILE_ONLY, false, "");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    {
+        ZLOG_TIMER("ERROR 异步写入");
+        for (int i = 0; i < syncTestCount; ++i) {
+            ZERROR() << "同步写入测试 " << i;
+        }
+        ZLOG_FLUSH();
+    }
+
+    ZLOG_SET_SYNCHRONOUS(ERROR, true);
+    {
+        ZLOG_TIMER("ERROR 同步写入");
+        for (int i = 0; i < syncTestCount; ++i) {
+            ZERROR() << "同步写入测试 " << i;
+        }
+    }
+
+    // 后台线程持续输出异步 INFO 日志时的同步写入开销
+    {
+        std::atomic<bool> running(true);
+        std::thread background([&running] {
+            int i = 0;
+            while (running.load()) {
+                ZINFO() << "后台异步日志 " << i++;
+            }
+            });
+
+        {
+            ZLOG_TIMER("ERROR 同步写入（后台异步 INFO）");
+            for (int i = 0; i < syncTestCount; ++i) {
+                ZERROR() << "同步写入测试 " << i;
+            }
+        }
+
+        running.store(false);
+        background.join();
+        ZLOG_FLUSH();
+    }
+
+    ZLOG_SET_SYNCHRONOUS(ERROR, false);
+    ZLOG_SET_OUTPUT_MODE(ZLOG_DEFAULT_MODE, false, "");
+    std::cout << "同步写入级别开销测试完成" << std::endl;
+}
+
+//==============================================================================
+// 8. 格式化线程池扩展性测试
+//==============================================================================
+
+void formatThreadsTest() {
+    std::cout << "\n=== 格式化线程池扩展性测试 ===" << std::endl;
+
+    const int formatTestCount = 100000;
+    const size_t threadCounts[] = { 0, 2, 4, 8 };
+
+    // 格式化并行进行，写入仍按序号顺序提交
+    ZLOG_SET_OUTPUT_MODE(ZLOG_FILE_ONLY, false, "");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (size_t threads : threadCounts) {
+        ZLOG_SET_FORMAT_THREADS(threads);
+        zlog::ZLogTimer timer("格式化线程数 " + std::to_string(threads), __FILE__, __LINE__);
+        for (int i = 0; i < formatTestCount; ++i) {
+            ZINFO() << "格式化测试 " << i << " 数据: " << (i * 1.5);
+        }
+        ZLOG_FLUSH();
+    }
+
+    ZLOG_SET_FORMAT_THREADS(0);
+    ZLOG_SET_OUTPUT_MODE(ZLOG_DEFAULT_MODE, false, "");
+    std::cout << "格式化线程池扩展性测试完成" << std::endl;
+}
+
+//==============================================================================
+// 9. 后台线程唤醒延迟测试
+//==============================================================================
+
+static long long steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void reportLatency(const std::string& name, std::vector<long long>& samples) {
+    if (samples.empty()) {
+        std::cout << name << ": 无样本" << std::endl;
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t index = static_cast<size_t>(p * (samples.size() - 1));
+        return samples[index] / 1000.0;
+    };
+
+    std::cout << name << " (" << samples.size() << "条): "
+        << "p50=" << percentile(0.50) << "us "
+        << "p90=" << percentile(0.90) << "us "
+        << "p99=" << percentile(0.99) << "us "
+        << "p99.9=" << percentile(0.999) << "us "
+        << "max=" << samples.back() / 1000.0 << "us" << std::endl;
+}
+
+void wakeupLatencyTest() {
+    std::cout << "\n=== 后台线程唤醒延迟测试 ===" << std::endl;
+
+    const int latencyTestCount = 2000;
+    const int spinSettings[] = { 0, 50, 200 };
+    const std::string shmName = "zlog.latency_test";
+
+    // 通过共享内存输出测量从调用日志接口到记录被写出的端到端延迟
+    ZLOG_SET_SHM_TARGET(shmName, 4 * 1024 * 1024);
+    ZLOG_SET_OUTPUT_MODE(zlog::SHM_OUT, false, "");
+
+    zlog::ZLogShmReader reader;
+    if (reader.open(shmName) != 0) {
+        std::cout << "无法打开共享内存，跳过测试" << std::endl;
+        ZLOG_SET_OUTPUT_MODE(ZLOG_DEFAULT_MODE, false, "");
+        return;
+    }
+
+    for (int spinUs : spinSettings) {
+        ZLOG_SET_WORKER_SPIN(spinUs);
+
+        std::vector<long long> samples;
+        samples.reserve(latencyTestCount);
+        std::atomic<bool> done(false);
+
+        std::thread consumer([&]() {
+            const char marker[] = "latency ";
+            while (true) {
+                size_t size = 0;
+                const char* data = reader.peek(size);
+                if (data == nullptr) {
+                    if (done.load()) {
+                        break;
+                    }
+                    reader.wait(10);
+                    continue;
+                }
+
+                long long received = steadyNowNs();
+                std::string record(data, size);
+                reader.consume();
+
+                size_t pos = record.find(marker);
+                if (pos != std::string::npos) {
+                    long long sent = std::strtoll(record.c_str() + pos + sizeof(marker) - 1, nullptr, 10);
+                    samples.push_back(received - sent);
+                }
+            }
+        });
+
+        // 每条日志之间留出间隔，使后台线程在下一条到来前进入空闲状态
+        for (int i = 0; i < latencyTestCount; ++i) {
+            ZINFO() << "latency " << steadyNowNs();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        ZLOG_FLUSH();
+        done.store(true);
+        consumer.join();
+
+        reportLatency("自旋 " + std::to_string(spinUs) + "us", samples);
+    }
+
+    ZLOG_SET_WORKER_SPIN(0);
+    ZLOG_SET_OUTPUT_MODE(ZLOG_DEFAULT_MODE, false, "");
+    std::cout << "后台线程唤醒延迟测试完成" << std::endl;
+}
+
 //==============================================================================
 // 主函数
 //==============================================================================
@@ -337,6 +557,10 @@ int main() {
         multiThreadPerformanceTest();
         complexScenarioTest();
         stressTest();
+        sizeRotateCheckTest();
+        synchronousLevelTest();
+        formatThreadsTest();
+        wakeupLatencyTest();
 
         // 输出最终统计
         std::cout << "\n========================================" << std::endl;
@@ -0,0 +1,69 @@
+/**
+ * ZLogging 共享内存日志读取示例
+ *
+ * 附加到 SHM_OUT 输出的共享内存环形缓冲区，直接在映射内存上读取记录并输出到标准输出。
+ * 写端关闭（共享内存名称被删除）且记录读完后重新等待同名缓冲区，可跟随重启后的日志进程。
+ *
+ * 用法：zlog-shm-reader <共享内存名称>
+ */
+
+#include "zlogshm.h"
+#include <csignal>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+
+static volatile std::sig_atomic_t g_running = 1;
+
+static void handleSignal(int) {
+    g_running = 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <shm-name>\n", argv[0]);
+        return 1;
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    zlog::ZLogShmReader reader;
+    while (g_running && reader.open(argv[1]) != 0) {
+        // 等待日志进程创建共享内存
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    size_t lastDropped = 0;
+    while (g_running) {
+        size_t size = 0;
+        const char* data = reader.peek(size);
+        if (data == nullptr) {
+            std::fflush(stdout);
+            if (!reader.isWriterActive()) {
+                // 写端已退出，读完剩余记录后等待新的写端创建同名缓冲区
+                reader.close();
+                lastDropped = 0;
+                while (g_running && reader.open(argv[1]) != 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                }
+                continue;
+            }
+            reader.wait(200);
+            continue;
+        }
+
+        std::fwrite(data, 1, size, stdout);
+        std::fputc('\n', stdout);
+        reader.consume();
+
+        size_t dropped = reader.getDroppedCount();
+        if (dropped != lastDropped) {
+            std::fprintf(stderr, "zlog-shm-reader: %zu records dropped by writer\n", dropped - lastDropped);
+            lastDropped = dropped;
+        }
+    }
+
+    std::fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * ZLogging syslog 输出测试
+ *
+ * 分别用 Unix 数据报套接字和 UDP 套接字接收 SYSLOG_OUT 发出的记录，
+ * 检查 RFC 5424 的 PRI、APP-NAME、PROCID、MSGID 和结构化数据，
+ * 并验证接收端停止读取时发送超时丢弃、不阻塞 flush。
+ *
+ * 用法：zlog_syslog_test（全部通过返回 0）
+ */
+
+#include "zlogging.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+static void setReceiveTimeout(int fd, int timeoutMs) {
+    struct timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static std::string receiveRecord(int fd) {
+    char buffer[16 * 1024];
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    return (n > 0) ? std::string(buffer, static_cast<size_t>(n)) : std::string();
+}
+
+static std::vector<std::string> splitHeader(const std::string& record, size_t count) {
+    // HEADER 各字段以单个空格分隔，最后一段是结构化数据和消息
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (fields.size() < count) {
+        size_t end = record.find(' ', start);
+        if (end == std::string::npos) {
+            break;
+        }
+        fields.push_back(record.substr(start, end - start));
+        start = end + 1;
+    }
+    fields.push_back(record.substr(start));
+    return fields;
+}
+
+static void checkRecord(const std::string& record, const std::string& pri, const std::string& appName,
+    const std::string& msgId, int line, const std::string& message) {
+    std::vector<std::string> fields = splitHeader(record, 6);
+    CHECK(fields.size() == 7);
+    if (fields.size() != 7) {
+        std::fprintf(stderr, "  record: %s\n", record.c_str());
+        return;
+    }
+
+    CHECK(fields[0] == pri + "1");
+    CHECK(fields[1].size() == 24 && fields[1].back() == 'Z');
+    CHECK(!fields[2].empty());
+    CHECK(fields[3] == appName);
+    CHECK(fields[4] == std::to_string(getpid()));
+    CHECK(fields[5] == msgId);
+
+    std::string sd = "[zlog@32473 file=\"syslog_test.cpp\" line=\"" + std::to_string(line) + "\" seq=\"";
+    CHECK(fields[6].compare(0, sd.size(), sd) == 0);
+    size_t sdEnd = fields[6].find("\"] ");
+    CHECK(sdEnd != std::string::npos && fields[6].substr(sdEnd + 3) == message);
+}
+
+static void testUnixDatagram() {
+    std::string path = "/tmp/zlog_syslog_test_" + std::to_string(getpid()) + ".sock";
+    unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    CHECK(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+    setReceiveTimeout(fd, 2000);
+
+    {
+        zlog::ZLogging logger("syslog-unix");
+        // 空格和控制字符不属于 PRINTUSASCII，应替换为 '-'
+        logger.setProgramName("my app\x01");
+        logger.setSyslogTarget("unix:" + path, 16);
+        logger.setOutputMode(zlog::SYSLOG_OUT, false, std::string());
+        CHECK(logger.initialize() == 0);
+
+        int line = __LINE__ + 1;
+        logger.logDirect(zlog::ZLOG_WARNING, "disk almost full", __FILE__, __FUNCTION__, line);
+        CHECK(logger.flush() == 0);
+
+        // facility=16(local0)，WARNING→4，PRI = 16*8+4
+        checkRecord(receiveRecord(fd), "<132>", "my-app-", "WARNING", line, "disk almost full");
+        CHECK(logger.getSyslogSentCount() == 1);
+        CHECK(logger.getSyslogDroppedCount() == 0);
+        logger.shutdown();
+    }
+
+    close(fd);
+    unlink(path.c_str());
+}
+
+static void testUdp() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CHECK(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+    socklen_t length = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &length);
+    setReceiveTimeout(fd, 2000);
+
+    {
+        zlog::ZLogging logger("syslog-udp");
+        logger.setProgramName("udp_test");
+        logger.setSyslogTarget("udp:127.0.0.1:" + std::to_string(ntohs(addr.sin_port)));
+        logger.setOutputMode(zlog::SYSLOG_OUT, false, std::string());
+        CHECK(logger.initialize() == 0);
+
+        int line = __LINE__ + 1;
+        logger.logDirect(zlog::ZLOG_ERROR, "quote \" and ] in message", __FILE__, __FUNCTION__, line);
+        logger.logDirect(zlog::ZLOG_INFO, "second", __FILE__, __FUNCTION__, line);
+        CHECK(logger.flush() == 0);
+
+        // 默认 facility=1(user)：ERROR→3，INFO→6
+        checkRecord(receiveRecord(fd), "<11>", "udp_test", "ERROR", line, "quote \" and ] in message");
+        checkRecord(receiveRecord(fd), "<14>", "udp_test", "INFO", line, "second");
+        CHECK(logger.getSyslogSentCount() == 2);
+        logger.shutdown();
+    }
+
+    close(fd);
+}
+
+static void testStalledReceiver() {
+    std::string path = "/tmp/zlog_syslog_stall_" + std::to_string(getpid()) + ".sock";
+    unlink(path.c_str());
+
+    // 接收端只绑定不读取，接收队列很快占满
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    int bufferSize = 4096;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    CHECK(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+
+    {
+        zlog::ZLogging logger("syslog-stall");
+        logger.setSyslogTarget("unix:" + path);
+        logger.setOutputMode(zlog::SYSLOG_OUT, false, std::string());
+        CHECK(logger.initialize() == 0);
+
+        const size_t total = 500;
+        for (size_t i = 0; i < total; ++i) {
+            logger.logDirect(zlog::ZLOG_INFO, "stalled " + std::to_string(i), __FILE__, __FUNCTION__, __LINE__);
+        }
+
+        // 每批最多等待 50ms，flush 必须在超时内返回，多出的记录计入丢弃数
+        auto start = std::chrono::steady_clock::now();
+        CHECK(logger.flush(5000) == 0);
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        CHECK(elapsedMs < 5000);
+
+        size_t sent = logger.getSyslogSentCount();
+        size_t dropped = logger.getSyslogDroppedCount();
+        CHECK(dropped > 0);
+        CHECK(sent + dropped + logger.getDroppedMessageCount() == total);
+        logger.shutdown();
+    }
+
+    close(fd);
+    unlink(path.c_str());
+}
+
+int main() {
+    testUnixDatagram();
+    testUdp();
+    testStalledReceiver();
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("syslog tests passed\n");
+    return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * ZLogging TCP 输出测试
+ *
+ * 在本地回环地址上监听，检查 TCP_OUT 的 4 字节大端长度前缀分帧、
+ * 收集端不可用时写入本地缓存、重连后按原顺序回放缓存，
+ * 以及缓存上限和重启后从磁盘加载的分段按条数计入丢弃。
+ *
+ * 用法：zlog_tcp_test（全部通过返回 0）
+ */
+
+#include "zlogging.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+static int listenOn(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct timeval tv = { 10, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static int getPort(int fd) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &length);
+    return ntohs(addr.sin_port);
+}
+
+static int acceptPeer(int listenFd) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd >= 0) {
+        struct timeval tv = { 3, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    return fd;
+}
+
+static std::vector<std::string> readFrames(int fd, size_t count) {
+    // 每帧为 4 字节大端长度加日志内容
+    std::vector<std::string> frames;
+    std::string buffer;
+    char chunk[64 * 1024];
+    while (frames.size() < count) {
+        while (buffer.size() >= 4) {
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(buffer.data());
+            size_t size = (size_t(header[0]) << 24) | (size_t(header[1]) << 16) | (size_t(header[2]) << 8) | size_t(header[3]);
+            if (buffer.size() < 4 + size) {
+                break;
+            }
+            frames.push_back(buffer.substr(4, size));
+            buffer.erase(0, 4 + size);
+        }
+        if (frames.size() >= count) {
+            break;
+        }
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    return frames;
+}
+
+static std::string makeMessage(const char* prefix, int index) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%s-%04d;", prefix, index);
+    return buffer;
+}
+
+static int getUnusedPort() {
+    int fd = listenOn(0);
+    int port = getPort(fd);
+    close(fd);
+    return port;
+}
+
+static size_t getDirectorySize(const std::string& dir) {
+    size_t total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return 0;
+    }
+    while (struct dirent* ent = readdir(d)) {
+        struct stat st;
+        if (ent->d_name[0] != '.' && stat((dir + "/" + ent->d_name).c_str(), &st) == 0) {
+            total += static_cast<size_t>(st.st_size);
+        }
+    }
+    closedir(d);
+    return total;
+}
+
+static void removeDirectory(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (d != nullptr) {
+        while (struct dirent* ent = readdir(d)) {
+            if (ent->d_name[0] != '.') {
+                unlink((dir + "/" + ent->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+static void configure(zlog::ZLogging& logger, int port, const std::string& spoolDir, size_t spoolMax) {
+    logger.setTcpTarget("tcp:127.0.0.1:" + std::to_string(port));
+    logger.setSpoolDirectory(spoolDir, spoolMax);
+    logger.setOutputMode(zlog::TCP_OUT, false, std::string());
+}
+
+static void testFraming(const std::string& spoolDir) {
+    int listenFd = listenOn(0);
+    CHECK(listenFd >= 0);
+
+    zlog::ZLogging logger("tcp-framing");
+    configure(logger, getPort(listenFd), spoolDir, zlog::DEFAULT_SPOOL_MAX_SIZE);
+    CHECK(logger.initialize() == 0);
+
+    int peer = acceptPeer(listenFd);
+    CHECK(peer >= 0);
+
+    for (int i = 0; i < 3; ++i) {
+        logger.logDirect(zlog::ZLOG_INFO, makeMessage("frame", i), __FILE__, __FUNCTION__, __LINE__);
+    }
+    CHECK(logger.flush() == 0);
+
+    std::vector<std::string> frames = readFrames(peer, 3);
+    CHECK(frames.size() == 3);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        CHECK(frames[i].find(makeMessage("frame", static_cast<int>(i))) != std::string::npos);
+        CHECK(frames[i].find("[INFO]") != std::string::npos);
+    }
+    CHECK(logger.getTcpSentCount() == 3);
+    CHECK(logger.getTcpDroppedCount() == 0);
+
+    CHECK(logger.shutdown() == 0);
+    close(peer);
+    close(listenFd);
+}
+
+static void testSpoolAndReplay(const std::string& spoolDir) {
+    int port = getUnusedPort();
+
+    zlog::ZLogging logger("tcp-replay");
+    configure(logger, port, spoolDir, zlog::DEFAULT_SPOOL_MAX_SIZE);
+    CHECK(logger.initialize() == 0);
+
+    // 收集端未启动，记录按顺序写入本地缓存
+    const int spooled = 100;
+    for (int i = 0; i < spooled; ++i) {
+        logger.logDirect(zlog::ZLOG_INFO, makeMessage("spool", i), __FILE__, __FUNCTION__, __LINE__);
+    }
+    CHECK(logger.flush() == 0);
+    CHECK(logger.getTcpSpooledCount() == static_cast<size_t>(spooled));
+    CHECK(logger.getTcpSentCount() == 0);
+    CHECK(getDirectorySize(spoolDir) > 0);
+
+    // 收集端启动后由后台线程按退避间隔重连，先回放缓存再发送新记录
+    int listenFd = listenOn(port);
+    CHECK(listenFd >= 0);
+    int peer = acceptPeer(listenFd);
+    CHECK(peer >= 0);
+
+    const int live = 5;
+    for (int i = 0; i < live; ++i) {
+        logger.logDirect(zlog::ZLOG_INFO, makeMessage("live", i), __FILE__, __FUNCTION__, __LINE__);
+    }
+    for (int i = 0; i < 50 && logger.getTcpSentCount() < static_cast<size_t>(spooled + live); ++i) {
+        logger.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::vector<std::string> frames = readFrames(peer, spooled + live);
+    CHECK(frames.size() == static_cast<size_t>(spooled + live));
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::string expected = (i < static_cast<size_t>(spooled))
+            ? makeMessage("spool", static_cast<int>(i)) : makeMessage("live", static_cast<int>(i) - spooled);
+        CHECK(frames[i].find(expected) != std::string::npos);
+    }
+    CHECK(logger.getTcpDroppedCount() == 0);
+
+    CHECK(logger.shutdown() == 0);
+    close(peer);
+    close(listenFd);
+}
+
+static void testSpoolCap(const std::string& spoolDir) {
+    int port = getUnusedPort();
+    const size_t spoolMax = 4096;
+
+    {
+        zlog::ZLogging logger("tcp-cap");
+        configure(logger, port, spoolDir, spoolMax);
+        CHECK(logger.initialize() == 0);
+
+        const size_t total = 200;
+        for (size_t i = 0; i < total; ++i) {
+            logger.logDirect(zlog::ZLOG_INFO, makeMessage("cap", static_cast<int>(i)), __FILE__, __FUNCTION__, __LINE__);
+        }
+        CHECK(logger.flush() == 0);
+
+        // 缓存大小不超过上限，超出的记录计入丢弃
+        CHECK(logger.getTcpSpooledCount() > 0);
+        CHECK(logger.getTcpDroppedCount() > 0);
+        CHECK(logger.getTcpSpooledCount() + logger.getTcpDroppedCount() == total);
+        CHECK(logger.shutdown() == 0);
+        CHECK(getDirectorySize(spoolDir) <= spoolMax);
+    }
+    removeDirectory(spoolDir);
+}
+
+static void testReloadedSegmentDrop(const std::string& spoolDir) {
+    int port = getUnusedPort();
+    const int first = 40;
+    size_t persisted = 0;
+
+    {
+        zlog::ZLogging logger("tcp-reload-1");
+        configure(logger, port, spoolDir, zlog::DEFAULT_SPOOL_MAX_SIZE);
+        CHECK(logger.initialize() == 0);
+        for (int i = 0; i < first; ++i) {
+            logger.logDirect(zlog::ZLOG_INFO, makeMessage("old", i), __FILE__, __FUNCTION__, __LINE__);
+        }
+        CHECK(logger.shutdown() == 0);
+        CHECK(logger.getTcpSpooledCount() == static_cast<size_t>(first));
+        persisted = getDirectorySize(spoolDir);
+        CHECK(persisted > 0);
+    }
+
+    {
+        // 上限容纳旧分段和一部分新记录；新分段写满时整段丢弃旧分段，
+        // 丢弃数必须等于旧分段中的记录数
+        size_t frameSize = persisted / first;
+        zlog::ZLogging logger("tcp-reload-2");
+        configure(logger, port, spoolDir, frameSize * (first + 30));
+        CHECK(logger.initialize() == 0);
+        for (int i = 0; i < 60; ++i) {
+            logger.logDirect(zlog::ZLOG_INFO, makeMessage("new", i), __FILE__, __FUNCTION__, __LINE__);
+        }
+        CHECK(logger.flush() == 0);
+        CHECK(logger.getTcpDroppedCount() == static_cast<size_t>(first));
+        CHECK(logger.getTcpSpooledCount() == 60);
+        CHECK(logger.shutdown() == 0);
+    }
+    removeDirectory(spoolDir);
+}
+
+int main() {
+    std::string base = "/tmp/zlog_tcp_test_" + std::to_string(getpid());
+    mkdir(base.c_str(), 0755);
+
+    testFraming(base + "/framing");
+    testSpoolAndReplay(base + "/replay");
+    testSpoolCap(base + "/cap");
+    testReloadedSegmentDrop(base + "/reload");
+
+    removeDirectory(base + "/framing");
+    removeDirectory(base + "/replay");
+    rmdir(base.c_str());
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("tcp tests passed\n");
+    return 0;
+}
@@ -0,0 +1,455 @@
+/**
+ * ZLogging 基准测试程序
+ *
+ * 与 performance_test 不同，本程序不经过控制台输出，结果以 JSON 输出到标准输出，
+ * 便于不同版本之间对比：
+ * - 单次调用延迟分布（p50/p99/p99.9/max），x86 下使用 rdtsc 计时
+ * - 1~64 线程的持续吞吐量
+ * - 被级别过滤的日志语句开销
+ * - 不同输出的开销（无输出、文件、tmpfs）
+ * - 突发写入下的丢弃率
+ *
+ * 用法: zlog_bench [--quick] [--output 文件]
+ */
+
+#include "zlogging.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ZLOG_BENCH_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define ZLOG_BENCH_RDTSC 1
+#endif
+
+// 测试参数（--quick 时缩小为十分之一）
+struct BenchConfig {
+    size_t latencyCount = 100000;       // 每种输出的延迟采样数
+    size_t throughputTotal = 400000;    // 吞吐测试的总日志数
+    size_t disabledCount = 10000000;    // 被过滤语句的调用次数
+    size_t burstPerThread = 50000;      // 突发测试中每线程日志数
+    size_t burstThreads = 4;            // 突发测试线程数
+};
+
+enum BenchSink {
+    SINK_NULL,
+    SINK_FILE,
+    SINK_TMPFS
+};
+
+static const char* getSinkName(BenchSink sink) {
+    switch (sink) {
+    case SINK_NULL:  return "null";
+    case SINK_FILE:  return "file";
+    case SINK_TMPFS: return "tmpfs";
+    default:         return "unknown";
+    }
+}
+
+//==============================================================================
+// 计时
+//==============================================================================
+
+static double nsPerTick = 1.0;
+
+static inline uint64_t readTicks() {
+#ifdef ZLOG_BENCH_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static const char* getTimerName() {
+#ifdef ZLOG_BENCH_RDTSC
+    return "rdtsc";
+#else
+    return "steady_clock";
+#endif
+}
+
+static void calibrateTicks() {
+#ifdef ZLOG_BENCH_RDTSC
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startTicks = readTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t endTicks = readTicks();
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    nsPerTick = ns / static_cast<double>(endTicks - startTicks);
+#else
+    nsPerTick = 1.0;
+#endif
+}
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//==============================================================================
+// 辅助函数
+//==============================================================================
+
+static bool tmpfsAvailable() {
+#ifdef __linux__
+    std::ofstream create("/dev/shm/.zlog_bench_probe");
+    bool ok = create.good();
+    create.close();
+    std::remove("/dev/shm/.zlog_bench_probe");
+    return ok;
+#else
+    return false;
+#endif
+}
+
+static std::unique_ptr<zlog::ZLogging> createLogger(BenchSink sink, size_t cacheSize) {
+    std::unique_ptr<zlog::ZLogging> logger(new zlog::ZLogging());
+    logger->setProgramName("zlog_bench");
+    logger->setMaxCacheSize(cacheSize);
+
+    switch (sink) {
+    case SINK_NULL:
+        logger->setOutputMode(0, false, "");
+        break;
+    case SINK_FILE:
+        logger->setOutputDirectory("./zlog_bench");
+        logger->setOutputMode(zlog::FILE_OUT, true, "bench.log");
+        break;
+    case SINK_TMPFS:
+        logger->setOutputDirectory("/dev/shm/zlog_bench");
+        logger->setOutputMode(zlog::FILE_OUT, true, "bench.log");
+        break;
+    }
+
+    logger->initialize();
+    return logger;
+}
+
+static void destroyLogger(std::unique_ptr<zlog::ZLogging>& logger) {
+    std::string path = logger->getUnifiedLogFilePath();
+    int mode = logger->getOutputMode();
+    logger->shutdown(-1);
+    logger.reset();
+
+    if ((mode & zlog::FILE_OUT) && !path.empty()) {
+        std::remove(path.c_str());
+    }
+}
+
+static void startTogether(std::atomic<size_t>& ready, size_t threadCount) {
+    ready.fetch_add(1);
+    while (ready.load() < threadCount) {
+        std::this_thread::yield();
+    }
+}
+
+//==============================================================================
+// JSON 输出
+//==============================================================================
+
+class JsonWriter {
+public:
+    void beginObject() { separate(); out_ << "{"; first_ = true; }
+    void endObject() { out_ << "}"; first_ = false; }
+    void beginArray(const char* key) { writeKey(key); out_ << "["; first_ = true; }
+    void endArray() { out_ << "]"; first_ = false; }
+    void beginObject(const char* key) { writeKey(key); out_ << "{"; first_ = true; }
+
+    void field(const char* key, double value) {
+        writeKey(key);
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+        out_ << buffer;
+    }
+
+    void field(const char* key, size_t value) { writeKey(key); out_ << value; }
+    void field(const char* key, bool value) { writeKey(key); out_ << (value ? "true" : "false"); }
+    void field(const char* key, const char* value) { writeKey(key); out_ << "\"" << value << "\""; }
+
+    std::string str() const { return out_.str(); }
+
+private:
+    void separate() {
+        if (!first_) {
+            out_ << ",";
+        }
+        first_ = false;
+    }
+
+    void writeKey(const char* key) {
+        separate();
+        out_ << "\"" << key << "\":";
+    }
+
+private:
+    std::ostringstream out_;
+    bool first_ = true;
+};
+
+static void writeLatency(JsonWriter& json, std::vector<uint64_t>& ticks) {
+    std::sort(ticks.begin(), ticks.end());
+
+    auto percentile = [&ticks](double p) {
+        size_t index = static_cast<size_t>(p * (ticks.size() - 1));
+        return ticks[index] * nsPerTick;
+    };
+
+    double sum = 0;
+    for (uint64_t tick : ticks) {
+        sum += tick * nsPerTick;
+    }
+
+    json.beginObject("latency_ns");
+    json.field("p50", percentile(0.50));
+    json.field("p99", percentile(0.99));
+    json.field("p99_9", percentile(0.999));
+    json.field("max", ticks.back() * nsPerTick);
+    json.field("mean", sum / ticks.size());
+    json.endObject();
+}
+
+//==============================================================================
+// 1. 输出开销：单次调用延迟分布与单线程吞吐
+//==============================================================================
+
+static void sinkBench(JsonWriter& json, const BenchConfig& config, BenchSink sink) {
+    std::cerr << "=== 输出开销: " << getSinkName(sink) << " ===" << std::endl;
+
+    std::vector<uint64_t> ticks(config.latencyCount);
+    {
+        std::unique_ptr<zlog::ZLogging> logger = createLogger(sink, config.latencyCount + 1);
+        for (size_t i = 0; i < config.latencyCount; ++i) {
+            uint64_t start = readTicks();
+            ZINFO_TO(*logger) << "latency sample " << i << " value=" << 3.14159;
+            ticks[i] = readTicks() - start;
+        }
+        destroyLogger(logger);
+    }
+
+    double seconds = 0;
+    size_t dropped = 0;
+    {
+        std::unique_ptr<zlog::ZLogging> logger = createLogger(sink, config.throughputTotal + 1);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < config.throughputTotal; ++i) {
+            ZINFO_TO(*logger) << "throughput sample " << i << " value=" << 3.14159;
+        }
+        logger->flush(-1);
+        seconds = elapsedSeconds(start);
+        dropped = logger->getDroppedMessageCount();
+        destroyLogger(logger);
+    }
+
+    json.beginObject();
+    json.field("sink", getSinkName(sink));
+    json.field("samples", config.latencyCount);
+    writeLatency(json, ticks);
+    json.field("throughput_msgs_per_sec", config.throughputTotal / seconds);
+    json.field("dropped", dropped);
+    json.endObject();
+}
+
+//==============================================================================
+// 2. 被级别过滤的语句开销
+//==============================================================================
+
+static void disabledBench(JsonWriter& json, const BenchConfig& config) {
+    std::cerr << "=== 被过滤语句开销 ===" << std::endl;
+
+    std::unique_ptr<zlog::ZLogging> logger = createLogger(SINK_NULL, 1000);
+
+    uint64_t start = readTicks();
+    for (size_t i = 0; i < config.disabledCount; ++i) {
+        ZDEBUG_TO(*logger) << "disabled " << i;
+    }
+    double streamNs = (readTicks() - start) * nsPerTick / config.disabledCount;
+
+    start = readTicks();
+    for (size_t i = 0; i < config.disabledCount; ++i) {
+        ZDEBUGF_TO(*logger, "disabled %zu", i);
+    }
+    double printfNs = (readTicks() - start) * nsPerTick / config.disabledCount;
+
+    destroyLogger(logger);
+
+    json.beginObject("disabled_ns");
+    json.field("calls", config.disabledCount);
+    json.field("stream", streamNs);
+    json.field("printf", printfNs);
+    json.endObject();
+}
+
+//==============================================================================
+// 3. 线程扩展性
+//==============================================================================
+
+static void threadScalingBench(JsonWriter& json, const BenchConfig& config) {
+    const size_t threadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    json.beginArray("thread_scaling");
+    for (size_t threadCount : threadCounts) {
+        std::cerr << "=== 线程扩展性: " << threadCount << " 线程 ===" << std::endl;
+
+        size_t perThread = config.throughputTotal / threadCount;
+        size_t total = perThread * threadCount;
+        std::unique_ptr<zlog::ZLogging> logger = createLogger(SINK_NULL, total + 1);
+
+        std::atomic<size_t> ready(0);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&logger, &ready, threadCount, perThread, t]() {
+                startTogether(ready, threadCount);
+                for (size_t i = 0; i < perThread; ++i) {
+                    ZINFO_TO(*logger) << "thread " << t << " message " << i;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double enqueueSeconds = elapsedSeconds(start);
+
+        logger->flush(-1);
+        double drainedSeconds = elapsedSeconds(start);
+        size_t dropped = logger->getDroppedMessageCount();
+        destroyLogger(logger);
+
+        json.beginObject();
+        json.field("threads", threadCount);
+        json.field("messages", total);
+        json.field("enqueue_msgs_per_sec", total / enqueueSeconds);
+        json.field("drained_msgs_per_sec", total / drainedSeconds);
+        json.field("dropped", dropped);
+        json.endObject();
+    }
+    json.endArray();
+}
+
+//==============================================================================
+// 4. 突发写入丢弃率
+//==============================================================================
+
+static void burstBench(JsonWriter& json, const BenchConfig& config, BenchSink sink) {
+    const size_t cacheSizes[] = { zlog::DEFAULT_MAX_CACHE_SIZE, 10000, 100000 };
+
+    json.beginArray("bursts");
+    for (size_t cacheSize : cacheSizes) {
+        std::cerr << "=== 突发写入: 缓存 " << cacheSize << " ===" << std::endl;
+
+        std::unique_ptr<zlog::ZLogging> logger = createLogger(sink, cacheSize);
+
+        std::atomic<size_t> ready(0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < config.burstThreads; ++t) {
+            threads.emplace_back([&logger, &ready, &config, t]() {
+                startTogether(ready, config.burstThreads);
+                for (size_t i = 0; i < config.burstPerThread; ++i) {
+                    ZINFO_TO(*logger) << "burst " << t << " message " << i;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        logger->flush(-1);
+        size_t offered = config.burstThreads * config.burstPerThread;
+        size_t dropped = logger->getDroppedMessageCount();
+        destroyLogger(logger);
+
+        json.beginObject();
+        json.field("sink", getSinkName(sink));
+        json.field("cache_size", cacheSize);
+        json.field("threads", config.burstThreads);
+        json.field("offered", offered);
+        json.field("dropped", dropped);
+        json.field("drop_rate", static_cast<double>(dropped) / offered);
+        json.endObject();
+    }
+    json.endArray();
+}
+
+//==============================================================================
+// 主函数
+//==============================================================================
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    bool quick = false;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else {
+            std::cerr << "用法: " << argv[0] << " [--quick] [--output 文件]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (quick) {
+        config.latencyCount /= 10;
+        config.throughputTotal /= 10;
+        config.disabledCount /= 10;
+        config.burstPerThread /= 10;
+    }
+
+    calibrateTicks();
+
+    std::vector<BenchSink> sinks = { SINK_NULL, SINK_FILE };
+    if (tmpfsAvailable()) {
+        sinks.push_back(SINK_TMPFS);
+    }
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("timer", getTimerName());
+    json.field("ns_per_tick", nsPerTick);
+    json.field("hardware_concurrency", static_cast<size_t>(std::thread::hardware_concurrency()));
+    json.field("quick", quick);
+
+    json.beginArray("sinks");
+    for (BenchSink sink : sinks) {
+        sinkBench(json, config, sink);
+    }
+    json.endArray();
+
+    disabledBench(json, config);
+    threadScalingBench(json, config);
+    burstBench(json, config, sinks.back());
+    json.endObject();
+
+    if (outputPath.empty()) {
+        std::cout << json.str() << std::endl;
+    }
+    else {
+        std::ofstream output(outputPath);
+        output << json.str() << std::endl;
+        if (!output.good()) {
+            std::cerr << "无法写入 " << outputPath << std::endl;
+            return 1;
+        }
+        std::cerr << "结果已写入 " << outputPath << std::endl;
+    }
+
+    return 0;
+}